@@ -0,0 +1,261 @@
+// src/BPlusTree.cpp
+#include "BPlusTree.h"
+#include <algorithm>
+
+using namespace std;
+
+BPlusTree::BPlusTree(size_t o) : order(o < 4 ? 4 : o), entryCount(0) {}
+
+BPlusTree::~BPlusTree() = default;
+
+BPlusTree::BPlusTree(BPlusTree&& other) noexcept
+    : root(move(other.root)), order(other.order), entryCount(other.entryCount) {
+    other.entryCount = 0;
+}
+
+BPlusTree& BPlusTree::operator=(BPlusTree&& other) noexcept {
+    if (this != &other) {
+        root = move(other.root);
+        order = other.order;
+        entryCount = other.entryCount;
+        other.entryCount = 0;
+    }
+    return *this;
+}
+
+int BPlusTree::compareEntry(const Value& aKey, size_t aRow, const Value& bKey, size_t bRow) {
+    int c = aKey.compare(bKey);
+    if (c != 0) return c;
+    return aRow < bRow ? -1 : (aRow > bRow ? 1 : 0);
+}
+
+// Index of the child whose subtree holds (key, rowId): the number of separators <= entry
+size_t BPlusTree::childIndex(const Node* node, const Value& key, size_t rowId) {
+    size_t lo = 0, hi = node->keys.size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (compareEntry(node->keys[mid], node->rowIds[mid], key, rowId) <= 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// First position in the node whose entry is >= (key, rowId)
+size_t BPlusTree::lowerBoundInNode(const Node* node, const Value& key, size_t rowId) {
+    size_t lo = 0, hi = node->keys.size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (compareEntry(node->keys[mid], node->rowIds[mid], key, rowId) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+unique_ptr<BPlusTree::Node> BPlusTree::insertInto(Node* node, const Value& key, size_t rowId,
+                                                  Value& splitKey, size_t& splitRowId) {
+    if (node->isLeaf) {
+        size_t pos = lowerBoundInNode(node, key, rowId);
+        node->keys.insert(node->keys.begin() + pos, key);
+        node->rowIds.insert(node->rowIds.begin() + pos, rowId);
+        if (node->keys.size() <= order) return nullptr;
+
+        // Split the leaf; the right half's first entry becomes the separator
+        size_t mid = node->keys.size() / 2;
+        unique_ptr<Node> right(new Node(true));
+        right->keys.assign(make_move_iterator(node->keys.begin() + mid), make_move_iterator(node->keys.end()));
+        right->rowIds.assign(node->rowIds.begin() + mid, node->rowIds.end());
+        node->keys.resize(mid);
+        node->rowIds.resize(mid);
+        right->next = node->next;
+        node->next = right.get();
+        splitKey = right->keys[0];
+        splitRowId = right->rowIds[0];
+        return right;
+    }
+
+    size_t ci = childIndex(node, key, rowId);
+    Value childSplitKey;
+    size_t childSplitRowId = 0;
+    unique_ptr<Node> newChild = insertInto(node->children[ci].get(), key, rowId, childSplitKey, childSplitRowId);
+    if (!newChild) return nullptr;
+
+    node->keys.insert(node->keys.begin() + ci, childSplitKey);
+    node->rowIds.insert(node->rowIds.begin() + ci, childSplitRowId);
+    node->children.insert(node->children.begin() + ci + 1, move(newChild));
+    if (node->keys.size() <= order) return nullptr;
+
+    // Split the internal node; the middle separator moves up
+    size_t mid = node->keys.size() / 2;
+    unique_ptr<Node> right(new Node(false));
+    splitKey = node->keys[mid];
+    splitRowId = node->rowIds[mid];
+    right->keys.assign(make_move_iterator(node->keys.begin() + mid + 1), make_move_iterator(node->keys.end()));
+    right->rowIds.assign(node->rowIds.begin() + mid + 1, node->rowIds.end());
+    right->children.assign(make_move_iterator(node->children.begin() + mid + 1),
+                           make_move_iterator(node->children.end()));
+    node->keys.resize(mid);
+    node->rowIds.resize(mid);
+    node->children.resize(mid + 1);
+    return right;
+}
+
+void BPlusTree::insert(const Value& key, size_t rowId) {
+    if (key.isNull) return;
+    if (!root) root.reset(new Node(true));
+
+    Value splitKey;
+    size_t splitRowId = 0;
+    unique_ptr<Node> right = insertInto(root.get(), key, rowId, splitKey, splitRowId);
+    if (right) {
+        unique_ptr<Node> newRoot(new Node(false));
+        newRoot->keys.push_back(splitKey);
+        newRoot->rowIds.push_back(splitRowId);
+        newRoot->children.push_back(move(root));
+        newRoot->children.push_back(move(right));
+        root = move(newRoot);
+    }
+    ++entryCount;
+}
+
+const BPlusTree::Node* BPlusTree::findLeaf(const Value& key, size_t rowId) const {
+    const Node* node = root.get();
+    while (node && !node->isLeaf) {
+        node = node->children[childIndex(node, key, rowId)].get();
+    }
+    return node;
+}
+
+const BPlusTree::Node* BPlusTree::leftmostLeaf() const {
+    const Node* node = root.get();
+    while (node && !node->isLeaf) {
+        node = node->children.front().get();
+    }
+    return node;
+}
+
+bool BPlusTree::erase(const Value& key, size_t rowId) {
+    if (key.isNull || !root) return false;
+
+    // Deletion is lazy: leaves may underflow (or empty) but separators still
+    // route correctly and range scans skip over empty leaves
+    Node* leaf = const_cast<Node*>(findLeaf(key, rowId));
+    size_t pos = lowerBoundInNode(leaf, key, rowId);
+    if (pos >= leaf->keys.size() || compareEntry(leaf->keys[pos], leaf->rowIds[pos], key, rowId) != 0) {
+        return false;
+    }
+    leaf->keys.erase(leaf->keys.begin() + pos);
+    leaf->rowIds.erase(leaf->rowIds.begin() + pos);
+    --entryCount;
+    return true;
+}
+
+void BPlusTree::clear() {
+    root.reset();
+    entryCount = 0;
+}
+
+void BPlusTree::renumber(const vector<size_t>& erasedRowIds) {
+    if (root && !erasedRowIds.empty()) renumberNode(root.get(), erasedRowIds);
+}
+
+// Separators naming an erased row map to the next surviving row id, which still
+// divides the children: entries left of it stay smaller, entries right of it stay >=
+void BPlusTree::renumberNode(Node* node, const vector<size_t>& erasedRowIds) {
+    for (size_t& rowId : node->rowIds) {
+        rowId -= lower_bound(erasedRowIds.begin(), erasedRowIds.end(), rowId) - erasedRowIds.begin();
+    }
+    for (auto& child : node->children) {
+        renumberNode(child.get(), erasedRowIds);
+    }
+}
+
+void BPlusTree::bulkLoad(vector<pair<Value, size_t>> entries) {
+    clear();
+    entries.erase(remove_if(entries.begin(), entries.end(),
+                            [](const pair<Value, size_t>& e) { return e.first.isNull; }),
+                  entries.end());
+    if (entries.empty()) return;
+
+    sort(entries.begin(), entries.end(), [](const pair<Value, size_t>& a, const pair<Value, size_t>& b) {
+        return compareEntry(a.first, a.second, b.first, b.second) < 0;
+    });
+
+    // Build full leaves left to right, then stack internal levels on top
+    vector<unique_ptr<Node>> level;
+    vector<pair<Value, size_t>> levelMins; // Smallest entry under each node
+    Node* prevLeaf = nullptr;
+    for (size_t i = 0; i < entries.size(); i += order) {
+        unique_ptr<Node> leaf(new Node(true));
+        size_t end = min(entries.size(), i + order);
+        for (size_t j = i; j < end; ++j) {
+            leaf->keys.push_back(move(entries[j].first));
+            leaf->rowIds.push_back(entries[j].second);
+        }
+        if (prevLeaf) prevLeaf->next = leaf.get();
+        prevLeaf = leaf.get();
+        levelMins.emplace_back(leaf->keys.front(), leaf->rowIds.front());
+        level.push_back(move(leaf));
+    }
+    entryCount = entries.size();
+
+    while (level.size() > 1) {
+        vector<unique_ptr<Node>> parents;
+        vector<pair<Value, size_t>> parentMins;
+        size_t fanout = order + 1;
+        for (size_t i = 0; i < level.size(); i += fanout) {
+            unique_ptr<Node> parent(new Node(false));
+            size_t end = min(level.size(), i + fanout);
+            for (size_t j = i; j < end; ++j) {
+                if (j > i) {
+                    parent->keys.push_back(levelMins[j].first);
+                    parent->rowIds.push_back(levelMins[j].second);
+                }
+                parent->children.push_back(move(level[j]));
+            }
+            parentMins.push_back(levelMins[i]);
+            parents.push_back(move(parent));
+        }
+        level = move(parents);
+        levelMins = move(parentMins);
+    }
+    root = move(level.front());
+}
+
+vector<size_t> BPlusTree::find(const Value& key) const {
+    return range(&key, true, &key, true);
+}
+
+vector<size_t> BPlusTree::range(const Value* low, bool lowInclusive,
+                                const Value* high, bool highInclusive) const {
+    vector<size_t> result;
+    if (!root) return result;
+    if ((low && low->isNull) || (high && high->isNull)) return result;
+
+    const Node* leaf;
+    size_t pos = 0;
+    if (low) {
+        leaf = findLeaf(*low, 0);
+        pos = lowerBoundInNode(leaf, *low, 0);
+    } else {
+        leaf = leftmostLeaf();
+    }
+
+    for (; leaf; leaf = leaf->next, pos = 0) {
+        for (; pos < leaf->keys.size(); ++pos) {
+            const Value& key = leaf->keys[pos];
+            if (low && !lowInclusive && key.compare(*low) == 0) continue;
+            if (high) {
+                int c = key.compare(*high);
+                if (c > 0 || (c == 0 && !highInclusive)) return result;
+            }
+            result.push_back(leaf->rowIds[pos]);
+        }
+    }
+    return result;
+}
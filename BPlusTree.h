@@ -0,0 +1,65 @@
+// include/BPlusTree.h
+#pragma once
+#include <vector>
+#include <memory>
+#include <utility>
+#include "Value.h"
+
+using namespace std;
+
+// In-memory B+tree mapping typed keys to row ids. Duplicate keys are allowed;
+// entries are ordered by (key, rowId) so every entry is unique and can be
+// erased exactly. Leaves are chained for range scans. NULL keys are not stored.
+class BPlusTree {
+public:
+    explicit BPlusTree(size_t order = 64);
+    ~BPlusTree();
+    BPlusTree(BPlusTree&& other) noexcept;
+    BPlusTree& operator=(BPlusTree&& other) noexcept;
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    void insert(const Value& key, size_t rowId);
+    bool erase(const Value& key, size_t rowId);
+    void clear();
+    // Shift row ids down past the erased rows (sorted); their entries must already be
+    // erased. The shift keeps (key, rowId) order, so the tree is relabelled in place.
+    void renumber(const vector<size_t>& erasedRowIds);
+    size_t size() const { return entryCount; }
+
+    // Replace the contents with the given entries (sorted here) in one pass
+    void bulkLoad(vector<pair<Value, size_t>> entries);
+
+    // Row ids whose key equals 'key', in key order
+    vector<size_t> find(const Value& key) const;
+
+    // Row ids with low <(=) key <(=) high; a null bound pointer means unbounded
+    vector<size_t> range(const Value* low, bool lowInclusive,
+                         const Value* high, bool highInclusive) const;
+
+private:
+    struct Node {
+        bool isLeaf;
+        vector<Value> keys;            // Leaf: entry keys; internal: separator keys
+        vector<size_t> rowIds;         // Parallel to keys
+        vector<unique_ptr<Node>> children;
+        Node* next;                    // Next leaf in key order
+
+        explicit Node(bool leaf) : isLeaf(leaf), next(nullptr) {}
+    };
+
+    unique_ptr<Node> root;
+    size_t order;
+    size_t entryCount;
+
+    static int compareEntry(const Value& aKey, size_t aRow, const Value& bKey, size_t bRow);
+    static size_t childIndex(const Node* node, const Value& key, size_t rowId);
+    static size_t lowerBoundInNode(const Node* node, const Value& key, size_t rowId);
+
+    // Inserts into the subtree; on split returns the new right sibling and its separator
+    unique_ptr<Node> insertInto(Node* node, const Value& key, size_t rowId,
+                                Value& splitKey, size_t& splitRowId);
+    static void renumberNode(Node* node, const vector<size_t>& erasedRowIds);
+    const Node* leftmostLeaf() const;
+    const Node* findLeaf(const Value& key, size_t rowId) const;
+};
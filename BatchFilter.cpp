@@ -0,0 +1,206 @@
+// src/BatchFilter.cpp
+#include "BatchFilter.h"
+#include "TableFile.h"
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+// mask[i] = (values[i] OP k) for a contiguous run. Written with the same
+// three-way logic as Value::compare (so NaN behaves identically) and without
+// branches so the loops vectorize.
+template <typename T, typename K>
+static void compareDense(CompareOp op, const T* values, size_t n, K k, uint8_t* mask) {
+    switch (op) {
+        case CompareOp::EQ:
+            for (size_t i = 0; i < n; ++i) mask[i] = !(values[i] < k) & !(values[i] > k);
+            break;
+        case CompareOp::NE:
+            for (size_t i = 0; i < n; ++i) mask[i] = (values[i] < k) | (values[i] > k);
+            break;
+        case CompareOp::LT:
+            for (size_t i = 0; i < n; ++i) mask[i] = values[i] < k;
+            break;
+        case CompareOp::LE:
+            for (size_t i = 0; i < n; ++i) mask[i] = !(values[i] > k);
+            break;
+        case CompareOp::GT:
+            for (size_t i = 0; i < n; ++i) mask[i] = values[i] > k;
+            break;
+        case CompareOp::GE:
+            for (size_t i = 0; i < n; ++i) mask[i] = !(values[i] < k);
+            break;
+    }
+}
+
+// Keeps the rows of 'in' whose mask byte is set
+static void selectByMask(const vector<uint32_t>& in, const vector<uint8_t>& mask, vector<uint32_t>& out) {
+    out.clear();
+    for (uint32_t idx : in) {
+        if (mask[idx]) out.push_back(idx);
+    }
+}
+
+static vector<uint32_t> denseSelection(size_t count) {
+    vector<uint32_t> selection(count);
+    for (size_t i = 0; i < count; ++i) selection[i] = static_cast<uint32_t>(i);
+    return selection;
+}
+
+void BatchFilter::filter(const ColumnStore& store, size_t begin, size_t count, vector<uint32_t>& selection) {
+    Block block{&store, nullptr, nullptr, begin, count};
+    evaluate(condition.root, block, denseSelection(count), selection);
+}
+
+void BatchFilter::filter(const vector<Row>& rows, size_t begin, size_t count, vector<uint32_t>& selection) {
+    Block block{nullptr, &rows, nullptr, begin, count};
+    evaluate(condition.root, block, denseSelection(count), selection);
+}
+
+void BatchFilter::filter(const TableFile& file, size_t begin, size_t count, vector<uint32_t>& selection) {
+    Block block{nullptr, nullptr, &file, begin, count};
+    evaluate(condition.root, block, denseSelection(count), selection);
+}
+
+void BatchFilter::evaluate(size_t n, const Block& block, const vector<uint32_t>& in, vector<uint32_t>& out) {
+    const BoundCondition::Node& node = condition.nodes[n];
+    switch (node.kind) {
+        case BoundCondition::NodeKind::TRUE_CONST:
+            out = in;
+            return;
+        case BoundCondition::NodeKind::FALSE_CONST:
+            out.clear();
+            return;
+        case BoundCondition::NodeKind::AND: {
+            // The right side only sees rows that passed the left side
+            vector<uint32_t> leftOut;
+            evaluate(node.left, block, in, leftOut);
+            if (leftOut.empty()) {
+                out.clear();
+                return;
+            }
+            evaluate(node.right, block, leftOut, out);
+            return;
+        }
+        case BoundCondition::NodeKind::OR: {
+            // The right side only sees rows the left side rejected
+            vector<uint32_t> leftOut, rest, rightOut;
+            evaluate(node.left, block, in, leftOut);
+            set_difference(in.begin(), in.end(), leftOut.begin(), leftOut.end(), back_inserter(rest));
+            if (!rest.empty()) evaluate(node.right, block, rest, rightOut);
+            out.clear();
+            set_union(leftOut.begin(), leftOut.end(), rightOut.begin(), rightOut.end(), back_inserter(out));
+            return;
+        }
+        case BoundCondition::NodeKind::COMPARE:
+            if (block.rows) {
+                compareRows(n, *block.rows, block.begin, block.count, in, out);
+            } else {
+                compareColumn(n, block, in, out);
+            }
+            return;
+    }
+}
+
+void BatchFilter::compareColumn(size_t n, const Block& block, const vector<uint32_t>& in, vector<uint32_t>& out) {
+    const BoundCondition::Node& node = condition.nodes[n];
+    const Value& k = node.constant;
+    size_t begin = block.begin;
+    size_t count = block.count;
+    mask.resize(count);
+
+    // Mapped pages are compared in place when they hold a native array
+    ColumnSlice col;
+    bool dense;
+    if (block.store) {
+        col = block.store->column(node.column).slice(begin);
+        dense = true;
+    } else {
+        dense = block.file->slice(node.column, begin, count, col);
+    }
+
+    if (dense && col.type == DataType::INTEGER && k.type == DataType::INTEGER) {
+        compareDense(node.op, col.ints, count, k.intValue, mask.data());
+    } else if (dense && col.type == DataType::INTEGER && k.isNumeric()) {
+        compareDense(node.op, col.ints, count, k.asDouble(), mask.data());
+    } else if (dense && col.type == DataType::FLOAT && k.isNumeric()) {
+        compareDense(node.op, col.floats, count, k.asDouble(), mask.data());
+    } else {
+        // Text and mixed-class comparisons go through the row-at-a-time path
+        out.clear();
+        for (uint32_t idx : in) {
+            bool match = block.store ? condition.evaluateColumns(n, *block.store, begin + idx)
+                                     : condition.evaluateMapped(n, *block.file, begin + idx);
+            if (match) out.push_back(idx);
+        }
+        return;
+    }
+
+    // NULLs never match
+    for (size_t i = 0; i < count; ++i) {
+        mask[i] &= !col.isNull(i);
+    }
+    selectByMask(in, mask, out);
+}
+
+void BatchFilter::compareRows(size_t n, const vector<Row>& rows, size_t begin, size_t count,
+                              const vector<uint32_t>& in, vector<uint32_t>& out) {
+    const BoundCondition::Node& node = condition.nodes[n];
+    const Value& k = node.constant;
+    if (!k.isNumeric()) {
+        out.clear();
+        for (uint32_t idx : in) {
+            if (condition.evaluateRow(n, rows[begin + idx])) out.push_back(idx);
+        }
+        return;
+    }
+
+    // Gather the column into contiguous buffers, then run the dense kernels:
+    // integers against an integer constant exactly, every other number as a
+    // double (as the columnar path does, e.g. FLOAT values against BMI < 30).
+    // Rows that do not hold a number are evaluated individually.
+    enum : uint8_t { GATHERED_INT, GATHERED_FLOAT, GATHERED_NONE };
+    bool intConstant = k.type == DataType::INTEGER;
+    bool anyInt = false, anyFloat = false;
+    gathered.resize(count);
+    intScratch.resize(count);
+    floatScratch.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const Row& row = rows[begin + i];
+        if (node.column >= row.values.size()) {
+            gathered[i] = GATHERED_NONE;
+            continue;
+        }
+        const Value& v = row.values[node.column];
+        if (v.isNull || !v.isNumeric()) {
+            gathered[i] = GATHERED_NONE;
+        } else if (intConstant && v.type == DataType::INTEGER) {
+            gathered[i] = GATHERED_INT;
+            intScratch[i] = v.intValue;
+            anyInt = true;
+        } else {
+            gathered[i] = GATHERED_FLOAT;
+            floatScratch[i] = v.asDouble();
+            anyFloat = true;
+        }
+    }
+    if (anyInt) {
+        mask.resize(count);
+        compareDense(node.op, intScratch.data(), count, k.intValue, mask.data());
+    }
+    if (anyFloat) {
+        floatMask.resize(count);
+        compareDense(node.op, floatScratch.data(), count, k.asDouble(), floatMask.data());
+    }
+
+    out.clear();
+    for (uint32_t idx : in) {
+        bool match;
+        switch (gathered[idx]) {
+            case GATHERED_INT: match = mask[idx] != 0; break;
+            case GATHERED_FLOAT: match = floatMask[idx] != 0; break;
+            default: match = condition.evaluateRow(n, rows[begin + idx]);
+        }
+        if (match) out.push_back(idx);
+    }
+}
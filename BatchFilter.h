@@ -0,0 +1,52 @@
+// include/BatchFilter.h
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "BoundCondition.h"
+
+using namespace std;
+
+class TableFile;
+
+// Rows are filtered in blocks of this many rows
+const size_t BATCH_SIZE = 1024;
+
+// Evaluates a BoundCondition over a block of rows at once. The rows that pass
+// are reported as a selection vector (ascending offsets into the block).
+// Comparisons run as tight per-column loops; AND narrows the selection and OR
+// merges the selections of its two sides.
+class BatchFilter {
+public:
+    explicit BatchFilter(const BoundCondition& c) : condition(c) {}
+
+    // Rows [begin, begin + count) of a column store; count <= BATCH_SIZE
+    void filter(const ColumnStore& store, size_t begin, size_t count, vector<uint32_t>& selection);
+
+    // Rows [begin, begin + count) of a row vector; count <= BATCH_SIZE
+    void filter(const vector<Row>& rows, size_t begin, size_t count, vector<uint32_t>& selection);
+
+    // Rows [begin, begin + count) of a mapped table file; count <= BATCH_SIZE
+    void filter(const TableFile& file, size_t begin, size_t count, vector<uint32_t>& selection);
+
+private:
+    // Where the block's values come from
+    struct Block {
+        const ColumnStore* store;
+        const vector<Row>* rows;
+        const TableFile* file;
+        size_t begin;
+        size_t count;
+    };
+
+    const BoundCondition& condition;
+    vector<uint8_t> mask;       // Per-row comparison result for the current leaf
+    vector<uint8_t> floatMask;  // Row mode: results for the values gathered as doubles
+    vector<uint8_t> gathered;   // Row mode: GATHERED_* buffer holding each row's value
+    vector<int64_t> intScratch; // Row mode: column gathered into contiguous buffers
+    vector<double> floatScratch;
+
+    void evaluate(size_t node, const Block& block, const vector<uint32_t>& in, vector<uint32_t>& out);
+    void compareColumn(size_t node, const Block& block, const vector<uint32_t>& in, vector<uint32_t>& out);
+    void compareRows(size_t node, const vector<Row>& rows, size_t begin, size_t count,
+                     const vector<uint32_t>& in, vector<uint32_t>& out);
+};
@@ -0,0 +1,172 @@
+// include/BinaryIO.h
+#pragma once
+#include <istream>
+#include <ostream>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include "Value.h"
+#include "Row.h"
+
+using namespace std;
+
+// Little-endian binary encoding of values and rows for spill and storage files.
+// Readers return false on a short or malformed read instead of throwing.
+class BinaryIO {
+public:
+    static void writeUint32(ostream& out, uint32_t v) {
+        char buf[4];
+        for (int i = 0; i < 4; ++i) buf[i] = static_cast<char>((v >> (8 * i)) & 0xFF);
+        out.write(buf, 4);
+    }
+
+    static void writeUint64(ostream& out, uint64_t v) {
+        char buf[8];
+        for (int i = 0; i < 8; ++i) buf[i] = static_cast<char>((v >> (8 * i)) & 0xFF);
+        out.write(buf, 8);
+    }
+
+    static void writeString(ostream& out, const string& s) {
+        writeUint32(out, static_cast<uint32_t>(s.size()));
+        out.write(s.data(), s.size());
+    }
+
+    // Type byte, NULL flag, then the payload for the type
+    static void writeValue(ostream& out, const Value& v) {
+        out.put(static_cast<char>(v.type));
+        out.put(v.isNull ? 1 : 0);
+        if (v.isNull) return;
+        switch (v.type) {
+            case DataType::INTEGER:
+                writeUint64(out, static_cast<uint64_t>(v.intValue));
+                break;
+            case DataType::FLOAT: {
+                uint64_t bits;
+                memcpy(&bits, &v.floatValue, sizeof(bits));
+                writeUint64(out, bits);
+                break;
+            }
+            case DataType::BOOLEAN:
+                out.put(v.boolValue ? 1 : 0);
+                break;
+            default:
+                writeString(out, v.data);
+                break;
+        }
+    }
+
+    static void writeRow(ostream& out, const Row& r) {
+        writeUint32(out, static_cast<uint32_t>(r.values.size()));
+        for (const auto& v : r.values) writeValue(out, v);
+    }
+
+    static bool readUint32(istream& in, uint32_t& v) {
+        unsigned char buf[4];
+        if (!in.read(reinterpret_cast<char*>(buf), 4)) return false;
+        v = 0;
+        for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(buf[i]) << (8 * i);
+        return true;
+    }
+
+    static bool readUint64(istream& in, uint64_t& v) {
+        unsigned char buf[8];
+        if (!in.read(reinterpret_cast<char*>(buf), 8)) return false;
+        v = 0;
+        for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(buf[i]) << (8 * i);
+        return true;
+    }
+
+    static bool readString(istream& in, string& s) {
+        uint32_t size;
+        if (!readUint32(in, size)) return false;
+        s.resize(size);
+        return size == 0 || static_cast<bool>(in.read(&s[0], size));
+    }
+
+    static bool readValue(istream& in, Value& v) {
+        int type = in.get();
+        int isNull = in.get();
+        if (!in || type < 0 || type > static_cast<int>(DataType::UNKNOWN)) return false;
+        DataType t = static_cast<DataType>(type);
+        if (isNull) {
+            v = Value::createNull(t);
+            return true;
+        }
+        switch (t) {
+            case DataType::INTEGER: {
+                uint64_t bits;
+                if (!readUint64(in, bits)) return false;
+                v = Value::fromInt(static_cast<int64_t>(bits));
+                return true;
+            }
+            case DataType::FLOAT: {
+                uint64_t bits;
+                if (!readUint64(in, bits)) return false;
+                double d;
+                memcpy(&d, &bits, sizeof(d));
+                v = Value::fromFloat(d);
+                return true;
+            }
+            case DataType::BOOLEAN: {
+                int b = in.get();
+                if (!in) return false;
+                v = Value::fromBool(b != 0);
+                return true;
+            }
+            default:
+                v = Value();
+                v.type = t;
+                return readString(in, v.data);
+        }
+    }
+
+    static bool readRow(istream& in, Row& r) {
+        uint32_t count;
+        if (!readUint32(in, count)) return false;
+        r.values.resize(count);
+        for (auto& v : r.values) {
+            if (!readValue(in, v)) return false;
+        }
+        return true;
+    }
+
+    // In-memory counterparts for building and parsing whole pages
+    static void appendUint32(string& out, uint32_t v) {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+
+    static void appendUint64(string& out, uint64_t v) {
+        for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+
+    static uint32_t loadUint32(const char* p) {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+        return v;
+    }
+
+    static uint64_t loadUint64(const char* p) {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+        return v;
+    }
+
+    // CRC-32 (IEEE 802.3); pass the previous result to checksum data in pieces
+    static uint32_t crc32(const char* data, size_t size, uint32_t crc = 0) {
+        static const auto table = [] {
+            array<uint32_t, 256> t{};
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[i] = c;
+            }
+            return t;
+        }();
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i) {
+            crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+};
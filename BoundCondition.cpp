@@ -0,0 +1,149 @@
+// src/BoundCondition.cpp
+#include "BoundCondition.h"
+#include "TableFile.h"
+
+using namespace std;
+
+BoundCondition::BoundCondition() : root(0) {
+    addNode(NodeKind::TRUE_CONST);
+}
+
+BoundCondition BoundCondition::bind(const Condition& c, const vector<Column>& columns) {
+    BoundCondition bound;
+    bound.nodes.clear();
+    bound.root = bound.bindNode(c, columns);
+    return bound;
+}
+
+void BoundCondition::collectColumns(vector<size_t>& out) const {
+    for (const auto& node : nodes) {
+        if (node.kind == NodeKind::COMPARE) out.push_back(node.column);
+    }
+}
+
+size_t BoundCondition::addNode(NodeKind kind) {
+    nodes.emplace_back();
+    nodes.back().kind = kind;
+    return nodes.size() - 1;
+}
+
+size_t BoundCondition::bindNode(const Condition& c, const vector<Column>& columns) {
+    // No WHERE clause matches every row
+    if (c.column.empty() && c.logicalOp == LogicalOperator::NONE) {
+        return addNode(NodeKind::TRUE_CONST);
+    }
+
+    if (c.logicalOp != LogicalOperator::NONE) {
+        if (!c.left || !c.right) return addNode(NodeKind::FALSE_CONST);
+        size_t left = bindNode(*c.left, columns);
+        size_t right = bindNode(*c.right, columns);
+        size_t n = addNode(c.logicalOp == LogicalOperator::AND ? NodeKind::AND : NodeKind::OR);
+        nodes[n].left = left;
+        nodes[n].right = right;
+        return n;
+    }
+
+    // Unknown columns and operators, and comparisons with NULL, never match
+    size_t colIdx = 0;
+    while (colIdx < columns.size() && columns[colIdx].name != c.column) ++colIdx;
+    if (colIdx == columns.size() || c.value.isNull) return addNode(NodeKind::FALSE_CONST);
+
+    CompareOp op;
+    if (c.op == "=") op = CompareOp::EQ;
+    else if (c.op == "!=" || c.op == "<>") op = CompareOp::NE;
+    else if (c.op == "<") op = CompareOp::LT;
+    else if (c.op == "<=") op = CompareOp::LE;
+    else if (c.op == ">") op = CompareOp::GT;
+    else if (c.op == ">=") op = CompareOp::GE;
+    else return addNode(NodeKind::FALSE_CONST);
+
+    size_t n = addNode(NodeKind::COMPARE);
+    nodes[n].op = op;
+    nodes[n].column = colIdx;
+    nodes[n].constant = c.value;
+    return n;
+}
+
+bool BoundCondition::applyOp(CompareOp op, int cmp) {
+    switch (op) {
+        case CompareOp::EQ: return cmp == 0;
+        case CompareOp::NE: return cmp != 0;
+        case CompareOp::LT: return cmp < 0;
+        case CompareOp::LE: return cmp <= 0;
+        case CompareOp::GT: return cmp > 0;
+        case CompareOp::GE: return cmp >= 0;
+    }
+    return false;
+}
+
+bool BoundCondition::evaluateRow(size_t n, const Row& r) const {
+    const Node& node = nodes[n];
+    switch (node.kind) {
+        case NodeKind::TRUE_CONST: return true;
+        case NodeKind::FALSE_CONST: return false;
+        case NodeKind::AND: return evaluateRow(node.left, r) && evaluateRow(node.right, r);
+        case NodeKind::OR: return evaluateRow(node.left, r) || evaluateRow(node.right, r);
+        case NodeKind::COMPARE: {
+            if (node.column >= r.values.size()) return false;
+            const Value& v = r.values[node.column];
+            if (v.isNull) return false;
+            return applyOp(node.op, v.compare(node.constant));
+        }
+    }
+    return false;
+}
+
+bool BoundCondition::evaluateMapped(size_t n, const TableFile& file, size_t rowId) const {
+    const Node& node = nodes[n];
+    switch (node.kind) {
+        case NodeKind::TRUE_CONST: return true;
+        case NodeKind::FALSE_CONST: return false;
+        case NodeKind::AND:
+            return evaluateMapped(node.left, file, rowId) && evaluateMapped(node.right, file, rowId);
+        case NodeKind::OR:
+            return evaluateMapped(node.left, file, rowId) || evaluateMapped(node.right, file, rowId);
+        case NodeKind::COMPARE: {
+            // Only the referenced column's page is touched
+            Value v = file.getValue(rowId, node.column);
+            if (v.isNull) return false;
+            return applyOp(node.op, v.compare(node.constant));
+        }
+    }
+    return false;
+}
+
+bool BoundCondition::evaluateColumns(size_t n, const ColumnStore& store, size_t rowId) const {
+    const Node& node = nodes[n];
+    switch (node.kind) {
+        case NodeKind::TRUE_CONST: return true;
+        case NodeKind::FALSE_CONST: return false;
+        case NodeKind::AND:
+            return evaluateColumns(node.left, store, rowId) && evaluateColumns(node.right, store, rowId);
+        case NodeKind::OR:
+            return evaluateColumns(node.left, store, rowId) || evaluateColumns(node.right, store, rowId);
+        case NodeKind::COMPARE: {
+            const ColumnVector& col = store.column(node.column);
+            if (col.isNull(rowId)) return false;
+
+            // Compare the stored payload directly when the constant has the same
+            // class, without materializing a Value
+            const Value& k = node.constant;
+            int cmp;
+            if (col.type == DataType::INTEGER && k.type == DataType::INTEGER) {
+                int64_t a = col.ints[rowId];
+                cmp = a < k.intValue ? -1 : (a > k.intValue ? 1 : 0);
+            } else if (col.type == DataType::FLOAT && k.isNumeric()) {
+                double a = col.floats[rowId];
+                double b = k.asDouble();
+                cmp = a < b ? -1 : (a > b ? 1 : 0);
+            } else if (!Value::isNumericType(col.type) && !k.isNumeric()) {
+                int c = col.strings[rowId].compare(k.data);
+                cmp = c < 0 ? -1 : (c > 0 ? 1 : 0);
+            } else {
+                cmp = col.get(rowId).compare(k);
+            }
+            return applyOp(node.op, cmp);
+        }
+    }
+    return false;
+}
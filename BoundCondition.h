@@ -0,0 +1,70 @@
+// include/BoundCondition.h
+#pragma once
+#include <vector>
+#include "Condition.h"
+#include "ColumnStore.h"
+
+using namespace std;
+
+class TableFile;
+
+enum class CompareOp {
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE
+};
+
+// A Condition compiled against a table schema once per query: column names are
+// resolved to indices, operators to CompareOp, and AND/OR short-circuit. The
+// result of evaluate() is the same as Condition::evaluate on the same row.
+class BoundCondition {
+public:
+    BoundCondition();   // Matches every row
+
+    static BoundCondition bind(const Condition& c, const vector<Column>& columns);
+
+    bool matchesAll() const { return nodes[root].kind == NodeKind::TRUE_CONST; }
+    // Appends the indices of the columns the condition reads
+    void collectColumns(vector<size_t>& out) const;
+
+    bool evaluate(const Row& r) const { return evaluateRow(root, r); }
+    bool evaluate(const ColumnStore& store, size_t rowId) const { return evaluateColumns(root, store, rowId); }
+    bool evaluate(const TableFile& file, size_t rowId) const { return evaluateMapped(root, file, rowId); }
+
+private:
+    friend class BatchFilter;
+
+    enum class NodeKind {
+        TRUE_CONST,
+        FALSE_CONST,
+        COMPARE,
+        AND,
+        OR
+    };
+
+    // Nodes are stored flat; children are referenced by position
+    struct Node {
+        NodeKind kind;
+        CompareOp op;
+        size_t column;
+        Value constant;
+        size_t left;
+        size_t right;
+
+        Node() : kind(NodeKind::FALSE_CONST), op(CompareOp::EQ), column(0), left(0), right(0) {}
+    };
+
+    vector<Node> nodes;
+    size_t root;
+
+    size_t bindNode(const Condition& c, const vector<Column>& columns);
+    size_t addNode(NodeKind kind);
+
+    bool evaluateRow(size_t n, const Row& r) const;
+    bool evaluateColumns(size_t n, const ColumnStore& store, size_t rowId) const;
+    bool evaluateMapped(size_t n, const TableFile& file, size_t rowId) const;
+    static bool applyOp(CompareOp op, int cmp);
+};
@@ -0,0 +1,108 @@
+// src/CSVFile.cpp
+#include "CSVFile.h"
+#include "CSVScanner.h"
+#include <stdexcept>
+
+using namespace std;
+
+CSVFile::CSVFile(const string& p) : path(p), file(p), records(nullptr) {
+    CSVScanner scanner(file.data(), dataEnd());
+    vector<CSVField> fields;
+    if (!scanner.nextRecord(fields) || CSVScanner::isBlank(fields)) {
+        throw runtime_error("CSV file has no header line: " + path);
+    }
+    for (size_t i = 0; i < fields.size(); ++i) {
+        string name = fields[i].text();
+        if (name.empty()) name = "column" + to_string(i + 1);
+        columns.emplace_back(name, DataType::VARCHAR);
+    }
+    records = scanner.position();
+    inferColumnTypes();
+}
+
+bool CSVFile::isTableExport(const string& path) {
+    try {
+        MappedFile mapped(path);
+        CSVScanner scanner(mapped.data(), mapped.data() + mapped.size());
+        vector<CSVField> names, types;
+        if (!scanner.nextRecord(names) || !scanner.nextRecord(types)) return false;
+        if (types.size() != names.size()) return false;
+        for (const auto& field : types) {
+            string type = field.text();
+            if (type != "INT" && type != "VARCHAR" && type != "FLOAT" && type != "BOOL" && type != "STRING") {
+                return false;
+            }
+        }
+        return true;
+    } catch (const exception&) {
+        return true; // Left to the import, which skips unreadable files
+    }
+}
+
+void CSVFile::inferColumnTypes() {
+    // Each column takes the narrowest type that every non-NULL sample value
+    // parses as: INTEGER, then FLOAT, then BOOLEAN, else VARCHAR
+    vector<bool> seen(columns.size(), false), ints(columns.size(), true),
+        floats(columns.size(), true), bools(columns.size(), true);
+    CSVScanner scanner(records, dataEnd());
+    vector<CSVField> fields;
+    size_t sampled = 0;
+    while (sampled < SAMPLE_RECORDS && scanner.nextRecord(fields)) {
+        if (CSVScanner::isBlank(fields)) continue;
+        ++sampled;
+        for (size_t i = 0; i < fields.size() && i < columns.size(); ++i) {
+            Value asInt = parseCSVValue(DataType::INTEGER, fields[i]);
+            if (asInt.isNull) continue; // Empty or "null"
+            seen[i] = true;
+            if (ints[i]) ints[i] = asInt.type == DataType::INTEGER;
+            if (floats[i]) floats[i] = parseCSVValue(DataType::FLOAT, fields[i]).type == DataType::FLOAT;
+            if (bools[i]) bools[i] = parseCSVValue(DataType::BOOLEAN, fields[i]).type == DataType::BOOLEAN;
+        }
+    }
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (!seen[i]) continue;
+        if (ints[i]) columns[i].type = DataType::INTEGER;
+        else if (floats[i]) columns[i].type = DataType::FLOAT;
+        else if (bools[i]) columns[i].type = DataType::BOOLEAN;
+    }
+}
+
+void CSVFile::buildRecordIndex() const {
+    call_once(indexed, [this]() {
+        CSVScanner scanner(records, dataEnd());
+        vector<CSVField> fields;
+        const char* start = scanner.position();
+        while (scanner.nextRecord(fields)) {
+            if (!CSVScanner::isBlank(fields)) recordStarts.push_back(start);
+            start = scanner.position();
+        }
+    });
+}
+
+size_t CSVFile::getRowCount() const {
+    buildRecordIndex();
+    return recordStarts.size();
+}
+
+Row CSVFile::getRow(size_t rowId) const {
+    buildRecordIndex();
+    CSVScanner scanner(recordStarts[rowId], dataEnd());
+    vector<CSVField> fields;
+    scanner.nextRecord(fields);
+    Row row;
+    row.values.reserve(columns.size());
+    for (size_t i = 0; i < columns.size(); ++i) {
+        row.values.push_back(i < fields.size() ? parseCSVValue(columns[i].type, fields[i])
+                                               : Value::createNull(columns[i].type));
+    }
+    return row;
+}
+
+Value CSVFile::getValue(size_t rowId, size_t colIdx) const {
+    buildRecordIndex();
+    CSVScanner scanner(recordStarts[rowId], dataEnd());
+    vector<CSVField> fields;
+    scanner.nextRecord(fields);
+    return colIdx < fields.size() ? parseCSVValue(columns[colIdx].type, fields[colIdx])
+                                  : Value::createNull(columns[colIdx].type);
+}
@@ -0,0 +1,54 @@
+// include/CSVFile.h
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+#include "Column.h"
+#include "Row.h"
+#include "MappedFile.h"
+
+using namespace std;
+
+// A plain CSV file (one header line of column names, then records) queried
+// in place as a read-only table (StorageMode::EXTERNAL). The file is
+// memory-mapped and column types are inferred from the first records;
+// values that do not fit the inferred type are kept as text. Queries stream
+// the records (see Table::scanRows); row-id access indexes every record's
+// offset on first use and is meant for rare paths such as foreign key checks.
+class CSVFile {
+public:
+    // Records sampled to infer the column types
+    static const size_t SAMPLE_RECORDS = 1000;
+
+    // Throws runtime_error if the file cannot be mapped or has no header line
+    explicit CSVFile(const string& path);
+
+    CSVFile(const CSVFile&) = delete;
+    CSVFile& operator=(const CSVFile&) = delete;
+
+    // True for a CSV written by Table::saveToCSV, whose second line holds the
+    // column types; such files are imported instead of queried in place
+    static bool isTableExport(const string& path);
+
+    const string& getPath() const { return path; }
+    const vector<Column>& getColumns() const { return columns; }
+    // The records after the header line
+    const char* dataBegin() const { return records; }
+    const char* dataEnd() const { return file.data() + file.size(); }
+
+    size_t getRowCount() const;
+    Row getRow(size_t rowId) const;
+    Value getValue(size_t rowId, size_t colIdx) const;
+
+private:
+    string path;
+    MappedFile file;
+    vector<Column> columns;
+    const char* records;
+
+    mutable once_flag indexed;
+    mutable vector<const char*> recordStarts;   // Built by the first row-id access
+
+    void inferColumnTypes();
+    void buildRecordIndex() const;
+};
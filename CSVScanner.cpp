@@ -0,0 +1,301 @@
+// src/CSVScanner.cpp
+#include "CSVScanner.h"
+#include <cstring>
+#include <charconv>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CSV_SCANNER_SSE2
+#endif
+
+using namespace std;
+
+static const size_t BLOCK_BYTES = 64;
+
+// Bit i is set when byte i of the block is the character
+struct BlockMasks {
+    uint64_t quotes;
+    uint64_t delimiters;
+    uint64_t newlines;
+};
+
+static BlockMasks classifyBlock(const char* p, char delimiter) {
+    BlockMasks m;
+#if defined(__AVX2__)
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+    auto match = [&](char c) {
+        __m256i needle = _mm256_set1_epi8(c);
+        uint64_t low = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, needle)));
+        uint64_t high = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, needle)));
+        return low | (high << 32);
+    };
+    m.quotes = match('"');
+    m.delimiters = match(delimiter);
+    m.newlines = match('\n');
+#elif defined(CSV_SCANNER_SSE2)
+    __m128i lanes[4];
+    for (int i = 0; i < 4; ++i) {
+        lanes[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+    }
+    auto match = [&](char c) {
+        __m128i needle = _mm_set1_epi8(c);
+        uint64_t bits = 0;
+        for (int i = 0; i < 4; ++i) {
+            uint64_t lane = static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(lanes[i], needle)));
+            bits |= lane << (16 * i);
+        }
+        return bits;
+    };
+    m.quotes = match('"');
+    m.delimiters = match(delimiter);
+    m.newlines = match('\n');
+#else
+    m.quotes = m.delimiters = m.newlines = 0;
+    for (size_t i = 0; i < BLOCK_BYTES; ++i) {
+        uint64_t bit = uint64_t(1) << i;
+        if (p[i] == '"') m.quotes |= bit;
+        else if (p[i] == delimiter) m.delimiters |= bit;
+        else if (p[i] == '\n') m.newlines |= bit;
+    }
+#endif
+    return m;
+}
+
+// Classifies a block that may run past 'end'; the missing bytes count as
+// ordinary characters
+static BlockMasks classifyTail(const char* p, const char* end, char delimiter) {
+    if (static_cast<size_t>(end - p) >= BLOCK_BYTES) return classifyBlock(p, delimiter);
+    char padded[BLOCK_BYTES] = {};
+    memcpy(padded, p, end - p);
+    return classifyBlock(padded, delimiter);
+}
+
+// Bit i of the result is the XOR of bits 0..i: set for bytes after an odd
+// number of quotes, i.e. inside a quoted field
+static uint64_t prefixXor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+static unsigned trailingZeros(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(bits));
+#else
+    unsigned n = 0;
+    while (!(bits & 1)) {
+        bits >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+static unsigned popCount(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_popcountll(bits));
+#else
+    bits = bits - ((bits >> 1) & 0x5555555555555555ULL);
+    bits = (bits & 0x3333333333333333ULL) + ((bits >> 2) & 0x3333333333333333ULL);
+    bits = (bits + (bits >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return static_cast<unsigned>((bits * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+string CSVField::text() const {
+    if (!escaped) return string(begin, end);
+    string out;
+    out.reserve(end - begin);
+    for (const char* p = begin; p < end; ++p) {
+        out.push_back(*p);
+        if (*p == '"' && p + 1 < end && p[1] == '"') ++p; // "" -> "
+    }
+    return out;
+}
+
+CSVScanner::CSVScanner(const char* begin, const char* end, char delimiter)
+    : blockStart(begin), end(end), fieldStart(begin), delimiter(delimiter), fieldEnds(0), quoteCarry(0) {
+    if (begin < end) loadBlock();
+}
+
+void CSVScanner::loadBlock() {
+    BlockMasks m = classifyTail(blockStart, end, delimiter);
+    uint64_t inQuotes = prefixXor(m.quotes) ^ quoteCarry;
+    quoteCarry = (inQuotes >> 63) ? ~uint64_t(0) : 0;
+    fieldEnds = (m.delimiters | m.newlines) & ~inQuotes;
+}
+
+CSVField CSVScanner::makeField(const char* b, const char* e, bool lineEnd) const {
+    if (lineEnd && e > b && e[-1] == '\r') --e;
+    CSVField field{b, e, false, false};
+    if (e > b && *b == '"') {
+        field.quoted = true;
+        field.begin = b + 1;
+        if (e - 1 > b && e[-1] == '"') field.end = e - 1;
+        field.escaped = memchr(field.begin, '"', field.end - field.begin) != nullptr;
+    }
+    return field;
+}
+
+bool CSVScanner::nextRecord(vector<CSVField>& fields) {
+    fields.clear();
+    if (fieldStart >= end) return false;
+    while (true) {
+        while (fieldEnds == 0) {
+            blockStart += BLOCK_BYTES;
+            if (blockStart >= end) {
+                // Last record, with no line break after it
+                fields.push_back(makeField(fieldStart, end, true));
+                fieldStart = end;
+                return true;
+            }
+            loadBlock();
+        }
+        const char* pos = blockStart + trailingZeros(fieldEnds);
+        fieldEnds &= fieldEnds - 1;
+        bool lineEnd = (*pos == '\n');
+        fields.push_back(makeField(fieldStart, pos, lineEnd));
+        fieldStart = pos + 1;
+        if (lineEnd) return true;
+    }
+}
+
+size_t CSVScanner::countQuotes(const char* begin, const char* end) {
+    size_t count = 0;
+    for (const char* p = begin; p < end; p += BLOCK_BYTES) {
+        count += popCount(classifyTail(p, end, '"').quotes);
+    }
+    return count;
+}
+
+const char* CSVScanner::nextRecordStart(const char* from, const char* end, bool inQuotes) {
+    for (const char* p = from; p < end; ++p) {
+        if (*p == '"') inQuotes = !inQuotes;
+        else if (*p == '\n' && !inQuotes) return p + 1;
+    }
+    return end;
+}
+
+const char* CSVScanner::recordBoundary(const char* begin, const char* end, size_t bytes) {
+    if (static_cast<size_t>(end - begin) <= bytes) return end;
+    const char* cut = begin + bytes;
+    return nextRecordStart(cut, end, (countQuotes(begin, cut) & 1) != 0);
+}
+
+static bool fieldEquals(const CSVField& field, const char* text) {
+    size_t length = strlen(text);
+    return static_cast<size_t>(field.end - field.begin) == length && memcmp(field.begin, text, length) == 0;
+}
+
+static bool isNullField(const CSVField& field) {
+    return fieldEquals(field, "null") || fieldEquals(field, "NULL");
+}
+
+static bool parseIntField(const CSVField& field, int64_t& out) {
+    const char* begin = field.begin;
+    if (begin < field.end && *begin == '+') ++begin;
+    if (begin == field.end) return false;
+    auto res = from_chars(begin, field.end, out);
+    return res.ec == errc() && res.ptr == field.end;
+}
+
+static bool parseFloatField(const CSVField& field, double& out) {
+    const char* begin = field.begin;
+    if (begin < field.end && *begin == '+') ++begin;
+    if (begin == field.end) return false;
+    auto res = from_chars(begin, field.end, out);
+    return res.ec == errc() && res.ptr == field.end;
+}
+
+static bool parseBoolField(const CSVField& field, bool& out) {
+    if (fieldEquals(field, "1") || fieldEquals(field, "true") || fieldEquals(field, "TRUE")) {
+        out = true;
+        return true;
+    }
+    if (fieldEquals(field, "0") || fieldEquals(field, "false") || fieldEquals(field, "FALSE")) {
+        out = false;
+        return true;
+    }
+    return false;
+}
+
+Value parseCSVValue(DataType type, const CSVField& field) {
+    if (isNullField(field) || (field.begin == field.end && Value::isNumericType(type))) {
+        return Value::createNull(type);
+    }
+    switch (type) {
+        case DataType::INTEGER: {
+            int64_t i;
+            if (parseIntField(field, i)) return Value::fromInt(i);
+            break;
+        }
+        case DataType::FLOAT: {
+            double f;
+            if (parseFloatField(field, f)) return Value::fromFloat(f);
+            break;
+        }
+        case DataType::BOOLEAN: {
+            bool b;
+            if (parseBoolField(field, b)) return Value::fromBool(b);
+            break;
+        }
+        default: {
+            Value v;
+            v.type = type;
+            v.data = field.text();
+            return v;
+        }
+    }
+    // Does not fit the type: kept as text
+    Value v;
+    v.type = DataType::STRING;
+    v.data = field.text();
+    return v;
+}
+
+void appendCSVValue(ColumnVector& column, const CSVField& field) {
+    if (isNullField(field)) {
+        column.appendNull();
+        return;
+    }
+    switch (column.type) {
+        case DataType::INTEGER: {
+            int64_t i;
+            if (parseIntField(field, i)) column.appendInt(i);
+            else column.appendNull();
+            break;
+        }
+        case DataType::FLOAT: {
+            double f;
+            if (parseFloatField(field, f)) column.appendFloat(f);
+            else column.appendNull();
+            break;
+        }
+        case DataType::BOOLEAN: {
+            bool b;
+            if (parseBoolField(field, b)) column.appendBool(b);
+            else column.appendNull();
+            break;
+        }
+        default:
+            column.appendText(field.text());
+    }
+}
+
+string quoteCSVField(const string& text, char delimiter) {
+    if (text.find_first_of(string{'"', '\n', '\r', delimiter}) == string::npos) return text;
+    string out = "\"";
+    for (char c : text) {
+        if (c == '"') out.push_back('"');
+        out.push_back(c);
+    }
+    out.push_back('"');
+    return out;
+}
@@ -0,0 +1,76 @@
+// include/CSVScanner.h
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "Value.h"
+#include "ColumnStore.h"
+
+using namespace std;
+
+// One field of a CSV record, pointing into the scanned buffer. A quoted
+// field excludes its quotes; 'escaped' means it still holds doubled quotes
+// ("") that text() collapses.
+struct CSVField {
+    const char* begin;
+    const char* end;
+    bool quoted;
+    bool escaped;
+
+    string text() const;
+};
+
+// RFC 4180 CSV reader over an in-memory buffer (e.g. a MappedFile). Bytes are
+// classified 64 at a time into bitmasks of quotes, delimiters and newlines
+// (AVX2 when compiled with it, else SSE2, else scalar). A prefix XOR of the
+// quote bits marks the bytes inside quoted fields, so delimiters and newlines
+// there are ignored and fields are found by walking set bits, not bytes.
+// Quotes are expected only around fields; a stray quote inside an unquoted
+// field opens a quoted section. "\r\n" line ends are accepted.
+class CSVScanner {
+public:
+    CSVScanner(const char* begin, const char* end, char delimiter = ',');
+
+    // Fields of the next record; false once the buffer is used up. An empty
+    // line is a record of one empty, unquoted field (see isBlank).
+    bool nextRecord(vector<CSVField>& fields);
+    // Where the next record starts
+    const char* position() const { return fieldStart; }
+
+    static bool isBlank(const vector<CSVField>& fields) {
+        return fields.size() == 1 && !fields[0].quoted && fields[0].begin == fields[0].end;
+    }
+
+    // For splitting a buffer between threads: quote bytes in [begin, end),
+    // whose parity tells whether a position is inside a quoted field, and
+    // the start of the first record after 'from' given that state
+    static size_t countQuotes(const char* begin, const char* end);
+    static const char* nextRecordStart(const char* from, const char* end, bool inQuotes);
+    // For streaming: the first record start at least 'bytes' past the record
+    // start 'begin', or 'end'
+    static const char* recordBoundary(const char* begin, const char* end, size_t bytes);
+
+private:
+    const char* blockStart;     // Current 64-byte block
+    const char* end;
+    const char* fieldStart;
+    char delimiter;
+    uint64_t fieldEnds;         // Unvisited delimiters and newlines outside quotes in the block
+    uint64_t quoteCarry;        // All ones if the next block starts inside quotes
+
+    void loadBlock();
+    CSVField makeField(const char* begin, const char* end, bool lineEnd) const;
+};
+
+// Parses a field with the same rules as Value(type, text): "null"/"NULL" is
+// NULL and text that does not fit the type is kept as a STRING. An empty
+// field of a numeric type is NULL too. Numbers are read straight from the
+// buffer with from_chars.
+Value parseCSVValue(DataType type, const CSVField& field);
+// Parses a field onto the end of a column; text that does not fit the
+// column type is stored as NULL, as ColumnVector::set does
+void appendCSVValue(ColumnVector& column, const CSVField& field);
+// The field as written to a CSV file: quoted if it holds a delimiter, quote
+// or line break
+string quoteCSVField(const string& text, char delimiter = ',');
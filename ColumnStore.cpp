@@ -0,0 +1,270 @@
+// src/ColumnStore.cpp
+#include "ColumnStore.h"
+#include <iterator>
+
+using namespace std;
+
+// Physical payload vector used for a logical type
+enum class PhysicalType { INT64, DOUBLE, BOOL, TEXT };
+
+static PhysicalType physicalTypeOf(DataType type) {
+    switch (type) {
+        case DataType::INTEGER: return PhysicalType::INT64;
+        case DataType::FLOAT: return PhysicalType::DOUBLE;
+        case DataType::BOOLEAN: return PhysicalType::BOOL;
+        default: return PhysicalType::TEXT;
+    }
+}
+
+void ColumnVector::setNullBit(size_t i, bool null) {
+    uint64_t mask = uint64_t(1) << (i & 63);
+    if (null) {
+        nullBits[i >> 6] |= mask;
+    } else {
+        nullBits[i >> 6] &= ~mask;
+    }
+}
+
+bool ColumnVector::fitsColumn(const Value& v) const {
+    switch (physicalTypeOf(type)) {
+        case PhysicalType::INT64: return v.type == DataType::INTEGER;
+        case PhysicalType::DOUBLE: return v.type == DataType::FLOAT;
+        case PhysicalType::BOOL: return v.type == DataType::BOOLEAN;
+        default: return !v.isNumeric();
+    }
+}
+
+void ColumnVector::growNullBits() {
+    if ((count & 63) == 0) nullBits.push_back(0);
+}
+
+void ColumnVector::append(const Value& v) {
+    growNullBits();
+    switch (physicalTypeOf(type)) {
+        case PhysicalType::INT64: ints.push_back(0); break;
+        case PhysicalType::DOUBLE: floats.push_back(0.0); break;
+        case PhysicalType::BOOL: bools.push_back(0); break;
+        case PhysicalType::TEXT: strings.emplace_back(); break;
+    }
+    ++count;
+    set(count - 1, v);
+}
+
+void ColumnVector::appendNull() {
+    growNullBits();
+    switch (physicalTypeOf(type)) {
+        case PhysicalType::INT64: ints.push_back(0); break;
+        case PhysicalType::DOUBLE: floats.push_back(0.0); break;
+        case PhysicalType::BOOL: bools.push_back(0); break;
+        case PhysicalType::TEXT: strings.emplace_back(); break;
+    }
+    setNullBit(count++, true);
+}
+
+// The null bit is cleared explicitly: eraseRows can leave stale bits past the end
+void ColumnVector::appendInt(int64_t v) {
+    growNullBits();
+    ints.push_back(v);
+    setNullBit(count++, false);
+}
+
+void ColumnVector::appendFloat(double v) {
+    growNullBits();
+    floats.push_back(v);
+    setNullBit(count++, false);
+}
+
+void ColumnVector::appendBool(bool v) {
+    growNullBits();
+    bools.push_back(v ? 1 : 0);
+    setNullBit(count++, false);
+}
+
+void ColumnVector::appendText(string&& v) {
+    growNullBits();
+    strings.push_back(move(v));
+    setNullBit(count++, false);
+}
+
+void ColumnVector::appendAll(ColumnVector&& other) {
+    size_t base = count;
+    switch (physicalTypeOf(type)) {
+        case PhysicalType::INT64: ints.insert(ints.end(), other.ints.begin(), other.ints.end()); break;
+        case PhysicalType::DOUBLE: floats.insert(floats.end(), other.floats.begin(), other.floats.end()); break;
+        case PhysicalType::BOOL: bools.insert(bools.end(), other.bools.begin(), other.bools.end()); break;
+        case PhysicalType::TEXT:
+            strings.insert(strings.end(), make_move_iterator(other.strings.begin()),
+                           make_move_iterator(other.strings.end()));
+            break;
+    }
+    count += other.count;
+
+    // The other bitmap starts at bit 'base' here, which need not be word
+    // aligned. Bits past the last row may be stale (eraseRows), so clear them.
+    size_t shift = base & 63;
+    if (shift != 0) nullBits[base >> 6] &= (uint64_t(1) << shift) - 1;
+    nullBits.resize((count + 63) / 64, 0);
+    for (size_t w = 0; w < other.nullBits.size(); ++w) {
+        uint64_t word = other.nullBits[w];
+        if (word == 0) continue;
+        size_t target = (base >> 6) + w;
+        nullBits[target] |= word << shift;
+        if (shift != 0 && target + 1 < nullBits.size()) {
+            nullBits[target + 1] |= word >> (64 - shift);
+        }
+    }
+    other.clear();
+}
+
+Value ColumnVector::get(size_t i) const {
+    if (isNull(i)) return Value::createNull(type);
+    switch (physicalTypeOf(type)) {
+        case PhysicalType::INT64: return Value::fromInt(ints[i]);
+        case PhysicalType::DOUBLE: return Value::fromFloat(floats[i]);
+        case PhysicalType::BOOL: return Value::fromBool(bools[i] != 0);
+        case PhysicalType::TEXT:
+        default: {
+            Value v;
+            v.type = type;
+            v.data = strings[i];
+            return v;
+        }
+    }
+}
+
+void ColumnVector::set(size_t i, const Value& v) {
+    if (v.isNull) {
+        setNullBit(i, true);
+        return;
+    }
+
+    // Values are normally coerced by Table before they get here; anything that
+    // still does not fit the column type is converted or, failing that, stored as NULL
+    Value converted;
+    const Value* src = &v;
+    if (!fitsColumn(v)) {
+        if (!v.tryConvert(type, converted)) {
+            setNullBit(i, true);
+            return;
+        }
+        src = &converted;
+    }
+
+    setNullBit(i, false);
+    switch (physicalTypeOf(type)) {
+        case PhysicalType::INT64: ints[i] = src->intValue; break;
+        case PhysicalType::DOUBLE: floats[i] = src->floatValue; break;
+        case PhysicalType::BOOL: bools[i] = src->boolValue ? 1 : 0; break;
+        case PhysicalType::TEXT: strings[i] = src->data; break;
+    }
+}
+
+void ColumnVector::eraseRows(const vector<size_t>& sortedRowIds) {
+    if (sortedRowIds.empty()) return;
+
+    // Compact surviving rows towards the front in a single pass
+    PhysicalType physical = physicalTypeOf(type);
+    size_t write = 0;
+    size_t nextErase = 0;
+    for (size_t read = 0; read < count; ++read) {
+        if (nextErase < sortedRowIds.size() && sortedRowIds[nextErase] == read) {
+            ++nextErase;
+            continue;
+        }
+        if (write != read) {
+            switch (physical) {
+                case PhysicalType::INT64: ints[write] = ints[read]; break;
+                case PhysicalType::DOUBLE: floats[write] = floats[read]; break;
+                case PhysicalType::BOOL: bools[write] = bools[read]; break;
+                case PhysicalType::TEXT: strings[write] = move(strings[read]); break;
+            }
+            setNullBit(write, isNull(read));
+        }
+        ++write;
+    }
+
+    count = write;
+    switch (physical) {
+        case PhysicalType::INT64: ints.resize(count); break;
+        case PhysicalType::DOUBLE: floats.resize(count); break;
+        case PhysicalType::BOOL: bools.resize(count); break;
+        case PhysicalType::TEXT: strings.resize(count); break;
+    }
+    nullBits.resize((count + 63) / 64);
+}
+
+void ColumnVector::reserve(size_t n) {
+    switch (physicalTypeOf(type)) {
+        case PhysicalType::INT64: ints.reserve(n); break;
+        case PhysicalType::DOUBLE: floats.reserve(n); break;
+        case PhysicalType::BOOL: bools.reserve(n); break;
+        case PhysicalType::TEXT: strings.reserve(n); break;
+    }
+    nullBits.reserve((n + 63) / 64);
+}
+
+void ColumnVector::clear() {
+    ints.clear();
+    floats.clear();
+    bools.clear();
+    strings.clear();
+    nullBits.clear();
+    count = 0;
+}
+
+void ColumnStore::reset(const vector<Column>& cols) {
+    columns.clear();
+    columns.reserve(cols.size());
+    for (const auto& col : cols) {
+        columns.emplace_back(col.type);
+    }
+    rows = 0;
+}
+
+void ColumnStore::clear() {
+    for (auto& col : columns) {
+        col.clear();
+    }
+    rows = 0;
+}
+
+void ColumnStore::reserve(size_t n) {
+    for (auto& col : columns) {
+        col.reserve(n);
+    }
+}
+
+void ColumnStore::appendRow(const Row& r) {
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i < r.values.size()) {
+            columns[i].append(r.values[i]);
+        } else {
+            columns[i].append(Value::createNull(columns[i].type));
+        }
+    }
+    ++rows;
+}
+
+void ColumnStore::appendRows(ColumnStore&& other) {
+    for (size_t i = 0; i < columns.size(); ++i) {
+        columns[i].appendAll(move(other.columns[i]));
+    }
+    rows += other.rows;
+    other.rows = 0;
+}
+
+Row ColumnStore::getRow(size_t rowId) const {
+    Row r;
+    r.values.reserve(columns.size());
+    for (const auto& col : columns) {
+        r.values.push_back(col.get(rowId));
+    }
+    return r;
+}
+
+void ColumnStore::eraseRows(const vector<size_t>& sortedRowIds) {
+    for (auto& col : columns) {
+        col.eraseRows(sortedRowIds);
+    }
+    rows -= sortedRowIds.size();
+}
@@ -0,0 +1,109 @@
+// include/ColumnStore.h
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "Value.h"
+#include "Column.h"
+#include "Row.h"
+
+using namespace std;
+
+// How a Table keeps its rows in memory
+enum class StorageMode {
+    ROW,        // vector<Row>, one heap-allocated Value vector per row
+    COLUMNAR,   // ColumnStore, one contiguous typed vector per column
+    MAPPED,     // Read in place from a memory-mapped table file (see Table::mapFromBinary)
+    EXTERNAL    // Streamed from a read-only CSV file at query time (see Table::attachCSV)
+};
+
+// A run of consecutive rows of one column whose payload is a contiguous typed
+// array, as held by a ColumnVector or a mapped table file page. Only the array
+// matching 'type' is set (none for text columns).
+struct ColumnSlice {
+    DataType type;
+    const int64_t* ints;        // INTEGER
+    const double* floats;       // FLOAT
+    const uint64_t* nullBits;   // Row i of the slice is bit (nullOffset + i); set = NULL
+    size_t nullOffset;
+
+    bool isNull(size_t i) const {
+        size_t bit = nullOffset + i;
+        return (nullBits[bit >> 6] >> (bit & 63)) & 1;
+    }
+};
+
+// A single column stored contiguously. Only the payload vector matching the
+// column's type is used; NULLs are tracked in a bitmap (bit set = NULL).
+class ColumnVector {
+public:
+    DataType type;
+    vector<int64_t> ints;       // INTEGER
+    vector<double> floats;      // FLOAT
+    vector<uint8_t> bools;      // BOOLEAN
+    vector<string> strings;     // STRING, VARCHAR, DATE, UNKNOWN
+    vector<uint64_t> nullBits;
+
+    ColumnVector() : type(DataType::UNKNOWN), count(0) {}
+    explicit ColumnVector(DataType t) : type(t), count(0) {}
+
+    size_t size() const { return count; }
+    bool isNull(size_t i) const { return (nullBits[i >> 6] >> (i & 63)) & 1; }
+    // Rows from 'begin' onwards
+    ColumnSlice slice(size_t begin) const {
+        return ColumnSlice{type, ints.data() + (ints.empty() ? 0 : begin),
+                           floats.data() + (floats.empty() ? 0 : begin), nullBits.data(), begin};
+    }
+
+    void append(const Value& v);
+    // Typed appends for bulk loads; the payload must match the column type
+    void appendNull();
+    void appendInt(int64_t v);
+    void appendFloat(double v);
+    void appendBool(bool v);
+    void appendText(string&& v);
+    // Moves all of 'other' (same type) onto the end of this column
+    void appendAll(ColumnVector&& other);
+    Value get(size_t i) const;
+    void set(size_t i, const Value& v);
+    void eraseRows(const vector<size_t>& sortedRowIds);
+    void reserve(size_t n);
+    void clear();
+
+private:
+    size_t count;
+
+    void setNullBit(size_t i, bool null);
+    void growNullBits();
+    bool fitsColumn(const Value& v) const;
+};
+
+// Column-major row storage; rows are addressed by their position (row id)
+class ColumnStore {
+public:
+    ColumnStore() : rows(0) {}
+
+    void reset(const vector<Column>& cols);
+    void clear();
+    void reserve(size_t n);
+
+    size_t rowCount() const { return rows; }
+    size_t columnCount() const { return columns.size(); }
+    const ColumnVector& column(size_t i) const { return columns[i]; }
+
+    void appendRow(const Row& r);
+    // Bulk loads append one value to every column through appendTarget and
+    // then call commitAppendedRow
+    ColumnVector& appendTarget(size_t col) { return columns[col]; }
+    void commitAppendedRow() { ++rows; }
+    // Moves the rows of 'other' (same columns) after the existing ones
+    void appendRows(ColumnStore&& other);
+    Row getRow(size_t rowId) const;
+    Value getValue(size_t rowId, size_t col) const { return columns[col].get(rowId); }
+    void setValue(size_t rowId, size_t col, const Value& v) { columns[col].set(rowId, v); }
+    void eraseRows(const vector<size_t>& sortedRowIds);
+
+private:
+    vector<ColumnVector> columns;
+    size_t rows;
+};
@@ -50,35 +50,10 @@ void Condition::resolveColumnAlias(const string& tableAlias) {
 }
 
 bool Condition::evaluate(const Row& r, const vector<Column>& columns) const {
-    // If no column specified (no WHERE clause), return true for all rows
-    if (column.empty() && logicalOp == LogicalOperator::NONE) {
-        return true;
-    }
-    
-    // Handle compound conditions (AND/OR)
-    if (logicalOp != LogicalOperator::NONE) {
-        if (!left || !right) return false;
-        
-        bool leftResult = left->evaluate(r, columns);
-        bool rightResult = right->evaluate(r, columns);
-        
-        if (logicalOp == LogicalOperator::AND) {
-            return leftResult && rightResult;
-        } else if (logicalOp == LogicalOperator::OR) {
-            return leftResult || rightResult;
-        }
-        return false;
-    }
-    
-    // Handle simple condition
-    // Find column index
-    auto it = find_if(columns.begin(), columns.end(), [&](const Column& c) { return c.name == column; });
-    if (it == columns.end()) return false;
-    size_t idx = distance(columns.begin(), it);
-
-    if (idx >= r.values.size()) return false;
-    const Value& rowVal = r.values[idx];
+    return evaluateWith([&](size_t idx) -> const Value& { return r.values[idx]; }, r.values.size(), columns);
+}
 
+bool Condition::compareWith(const Value& rowVal) const {
     // Handle NULL comparisons:
     // In SQL, NULL comparisons with =, !=, <, > always return false
     // Use IS NULL or IS NOT NULL for NULL checks (not implemented here yet)
@@ -37,4 +37,44 @@ public:
     void resolveColumnAlias(const string& tableAlias);
 
     bool evaluate(const Row& r, const vector<Column>& columns) const;
+
+    // Evaluate against any row source: valueAt(columnIndex) returns the cell
+    // value, valueCount is the number of cells in the row
+    template <typename ValueAt>
+    bool evaluateWith(const ValueAt& valueAt, size_t valueCount, const vector<Column>& columns) const;
+
+private:
+    bool compareWith(const Value& rowVal) const;
 };
+
+template <typename ValueAt>
+bool Condition::evaluateWith(const ValueAt& valueAt, size_t valueCount, const vector<Column>& columns) const {
+    // If no column specified (no WHERE clause), return true for all rows
+    if (column.empty() && logicalOp == LogicalOperator::NONE) {
+        return true;
+    }
+    
+    // Handle compound conditions (AND/OR)
+    if (logicalOp != LogicalOperator::NONE) {
+        if (!left || !right) return false;
+        
+        bool leftResult = left->evaluateWith(valueAt, valueCount, columns);
+        bool rightResult = right->evaluateWith(valueAt, valueCount, columns);
+        
+        if (logicalOp == LogicalOperator::AND) {
+            return leftResult && rightResult;
+        } else if (logicalOp == LogicalOperator::OR) {
+            return leftResult || rightResult;
+        }
+        return false;
+    }
+    
+    // Handle simple condition
+    // Find column index
+    size_t idx = 0;
+    while (idx < columns.size() && columns[idx].name != column) ++idx;
+    if (idx == columns.size()) return false;
+
+    if (idx >= valueCount) return false;
+    return compareWith(valueAt(idx));
+}
@@ -0,0 +1,45 @@
+// include/CopyOnWrite.h
+#pragma once
+#include <memory>
+
+using namespace std;
+
+// A value shared by its copies until one of them is modified: copying is a
+// reference count increment, and write() first clones the value if another
+// copy still holds it. Reads go through * and ->. Copies and writes must
+// happen on one thread; other threads may read a copy they were handed.
+template <typename T>
+class CopyOnWrite {
+public:
+    CopyOnWrite() : value(make_shared<T>()) {}
+    CopyOnWrite(const CopyOnWrite&) = default;
+    CopyOnWrite& operator=(const CopyOnWrite&) = default;
+    // The source is left holding an empty value
+    CopyOnWrite(CopyOnWrite&& other) noexcept : value(move(other.value)) { other.value = empty(); }
+    CopyOnWrite& operator=(CopyOnWrite&& other) noexcept {
+        if (this != &other) {
+            value = move(other.value);
+            other.value = empty();
+        }
+        return *this;
+    }
+
+    const T& operator*() const { return *value; }
+    const T* operator->() const { return value.get(); }
+
+    T& write() {
+        if (value.use_count() > 1) value = make_shared<T>(*value);
+        return *value;
+    }
+    // A fresh default value, without cloning a shared one first
+    void discard() { value = make_shared<T>(); }
+
+private:
+    shared_ptr<T> value;
+
+    // Shared by every moved-from copy; never written, since write() sees it shared
+    static const shared_ptr<T>& empty() {
+        static const shared_ptr<T> value = make_shared<T>();
+        return value;
+    }
+};
@@ -0,0 +1,13 @@
+// include/CopyQuery.h
+#pragma once
+#include "Query.h"
+#include <string>
+using namespace std;
+
+class CopyQuery : public Query {
+public:
+    string tableName;
+    string filePath; // CSV file whose header line names the columns present
+
+    CopyQuery() { type = QueryType::COPY; }
+};
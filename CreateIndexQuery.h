@@ -0,0 +1,14 @@
+// include/CreateIndexQuery.h
+#pragma once
+#include "Query.h"
+#include <string>
+using namespace std;
+
+class CreateIndexQuery : public Query {
+public:
+    string indexName;
+    string tableName;
+    string columnName;
+
+    CreateIndexQuery() { type = QueryType::CREATE_INDEX; }
+};
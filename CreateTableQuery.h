@@ -2,6 +2,7 @@
 #pragma once
 #include "Query.h"
 #include "Column.h"
+#include "ColumnStore.h"
 #include <string>
 #include <vector>
 using namespace std;
@@ -12,6 +13,8 @@ class CreateTableQuery : public Query {
 public:
     string tableName;
     vector<Column> columns;
+    StorageMode storageMode; // USING COLUMNAR selects the column store
+    string externalPath;     // CREATE EXTERNAL TABLE ... FROM '<file>'; columns come from the file
 
-    CreateTableQuery() { type = QueryType::CREATE_TABLE; }
+    CreateTableQuery() : storageMode(StorageMode::ROW) { type = QueryType::CREATE_TABLE; }
 };
@@ -4,45 +4,408 @@
 #include <direct.h>
 #include <filesystem> // C++17 for directory iteration
 #include <stdexcept>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include "FileSync.h"
+#include "ThreadPool.h"
+#include "CSVFile.h"
 
 using namespace std;
 
-void Database::createTable(const string& name, const vector<Column>& cols) {
-    if (tables.find(name) != tables.end()) {
+void Database::createTable(const string& name, const vector<Column>& cols, StorageMode mode) {
+    if (hasTable(name)) {
         throw runtime_error("Table already exists: " + name);
     }
-    tables.emplace(name, Table(name, cols));
+    Table& table = tables.emplace(name, Table(name, cols, mode)).first->second;
+    if (log) {
+        table.setLogSequence(log->logCreateTable(name, cols, mode));
+        table.setRedoLog(log.get());
+    }
+    CatalogEntry& entry = catalog[name];
+    entry.columns = cols;
+    entry.lastUsed = ++useClock;
+    ++catalogVersion;
+}
+
+void Database::createExternalTable(const string& name, const string& filePath) {
+    if (hasTable(name)) {
+        throw runtime_error("Table already exists: " + name);
+    }
+    Table table(name, {}, defaultStorageMode); // Columns come from the file
+    table.attachCSV(filePath);
+
+    // A running checkpoint writes the catalog too
+    finishCheckpoint(true);
+    CatalogEntry& entry = catalog[name];
+    entry.columns = table.getColumns();
+    entry.externalPath = filesystem::absolute(filePath).string();
+    entry.lastUsed = ++useClock;
+    tables.emplace(name, move(table));
+    ++catalogVersion;
+    writeCatalog();
 }
 
 Table* Database::getTable(const string& name) {
+    auto entryIt = catalog.find(name);
+    if (entryIt == catalog.end()) return nullptr;
+    entryIt->second.lastUsed = ++useClock;
+
+    auto it = tables.find(name);
+    if (it != tables.end()) return &it->second;
+    return loadTable(name, entryIt->second);
+}
+
+Table* Database::loadTable(const string& name, CatalogEntry& entry) {
+    Table table(name, {}, defaultStorageMode); // Temp, will load columns
+    if (!entry.externalPath.empty()) {
+        table.attachCSV(entry.externalPath);
+        return &tables.emplace(name, move(table)).first->second;
+    }
+    if (mapTableFiles) {
+        table.mapFromBinary(entry.filePath);
+    } else {
+        table.loadFromBinary(entry.filePath);
+    }
+    for (const auto& index : entry.indexes) {
+        table.createIndex(index.first, index.second);
+    }
+    entry.indexes.clear();
+    table.setRedoLog(log.get());
+    return &tables.emplace(name, move(table)).first->second;
+}
+
+const vector<Column>* Database::getTableColumns(const string& name) const {
     auto it = tables.find(name);
-    if (it == tables.end()) return nullptr;
-    return &it->second;
+    if (it != tables.end()) return &it->second.getColumns();
+    auto entryIt = catalog.find(name);
+    return entryIt == catalog.end() ? nullptr : &entryIt->second.columns;
+}
+
+Table* Database::findTableByIndex(const string& indexName) {
+    for (auto& pair : tables) {
+        if (pair.second.hasIndex(indexName)) return &pair.second;
+    }
+    // Indexes of unloaded tables are only definitions
+    for (const auto& pair : catalog) {
+        for (const auto& index : pair.second.indexes) {
+            if (index.first == indexName) return getTable(pair.first);
+        }
+    }
+    return nullptr;
 }
 
 void Database::dropTable(const string& name) {
+    // A running checkpoint may still write the table's file
+    finishCheckpoint(true);
+    auto entryIt = catalog.find(name);
+    if (entryIt != catalog.end() && !entryIt->second.externalPath.empty()) {
+        // The file is the user's data and stays; only catalog.def knows the
+        // table. A CSV in the storage directory is ignored from now on, or
+        // the next load would attach it again.
+        string csvPath = storagePath + "/" + name + ".csv";
+        error_code ec;
+        if (filesystem::equivalent(entryIt->second.externalPath, csvPath, ec)) {
+            ignoredCSVFiles.insert(name);
+        }
+        tables.erase(name);
+        catalog.erase(entryIt);
+        ++catalogVersion;
+        writeCatalog();
+        return;
+    }
+    if (log) {
+        // The drop must be durable before the files are gone
+        log->logDropTable(name);
+        log->commit();
+    }
     tables.erase(name);
-    string filePath = storagePath + "/" + name + ".csv";
-    remove(filePath.c_str());
+    catalog.erase(name);
+    ++catalogVersion;
+    remove(tableFilePath(name).c_str());
+    // An imported CSV would bring the table back on the next load; an
+    // ignored one is not ours to delete
+    if (!ignoredCSVFiles.count(name)) {
+        string csvPath = storagePath + "/" + name + ".csv";
+        remove(csvPath.c_str());
+    }
 }
 
 void Database::loadAllTables() {
     namespace fs = filesystem;
+    loadErrors.clear();
+    checkpoint.reset(); // Waits for its thread; the log still has its records
+    log.reset();
+    tables.clear();
+    catalog.clear();
+    ignoredCSVFiles.clear();
+
+    // catalog.def: secondary indexes, one "INDEX,name,table,column" line
+    // each; external tables, one "EXTERNAL,table,path" line each; and CSV
+    // files of dropped external tables, one "IGNORE,table" line each
+    vector<string> catalogLines;
+    {
+        ifstream catalogFile(storagePath + "/catalog.def");
+        string line;
+        while (getline(catalogFile, line)) {
+            if (line.compare(0, 7, "IGNORE,") != 0) {
+                catalogLines.push_back(line);
+                continue;
+            }
+            string tableName = line.substr(7);
+            // Forgotten once the file is gone
+            if (fs::exists(storagePath + "/" + tableName + ".csv")) ignoredCSVFiles.insert(tableName);
+        }
+    }
+
+    uint64_t fileSequence = 0; // Highest LSN stored in a table file
+    vector<pair<string, string>> csvImports; // Table name, CSV path
     for (const auto& entry : fs::directory_iterator(storagePath)) {
-        if (entry.is_regular_file() && entry.path().extension() == ".csv") {
-            string tableName = entry.path().stem().string();
-            Table table(tableName, {}); // Temp, will load columns
-            table.loadFromCSV(entry.path().string());
-            tables[tableName] = move(table);
+        if (!entry.is_regular_file()) continue;
+        string extension = entry.path().extension().string();
+        string tableName = entry.path().stem().string();
+
+        if (extension == ".tmp") {
+            // Left behind by an interrupted save; the target file is intact
+            fs::remove(entry.path());
+        } else if (extension == ".tbl") {
+            // Only the schema is read; rows wait for the first getTable
+            try {
+                TableFile file(entry.path().string());
+                CatalogEntry& catalogEntry = catalog[tableName];
+                catalogEntry.columns = file.getColumns();
+                catalogEntry.filePath = tableFilePath(tableName);
+                fileSequence = max(fileSequence, file.getLogSequence());
+            } catch (const exception& e) {
+                // Keep the file for inspection; the table stays unloaded
+                loadErrors.push_back(e.what());
+            }
+        } else if (extension == ".csv") {
+            if (fs::exists(tableFilePath(tableName)) || ignoredCSVFiles.count(tableName)) continue;
+            csvImports.emplace_back(tableName, entry.path().string());
+        }
+    }
+
+    // CSV files are opened concurrently, one task per file (each import is
+    // itself split across the pool), then added in a single pass. Plain CSV
+    // files (a header line, then records) become external tables.
+    vector<Table> imported;
+    vector<string> importErrors(csvImports.size());
+    imported.reserve(csvImports.size());
+    for (const auto& import : csvImports) {
+        imported.emplace_back(import.first, vector<Column>{}, defaultStorageMode); // Columns come from the file
+    }
+    ThreadPool::instance().parallelFor(csvImports.size(), [&](size_t i) {
+        const string& csvPath = csvImports[i].second;
+        try {
+            if (CSVFile::isTableExport(csvPath)) {
+                imported[i].loadFromCSV(csvPath);
+            } else {
+                imported[i].attachCSV(csvPath);
+            }
+        } catch (const exception& e) {
+            importErrors[i] = e.what();
+        }
+    });
+    for (size_t i = 0; i < imported.size(); ++i) {
+        if (!importErrors[i].empty()) {
+            loadErrors.push_back(importErrors[i]);
+            continue;
+        }
+        const string& tableName = csvImports[i].first;
+        CatalogEntry& entry = catalog[tableName];
+        entry.columns = imported[i].getColumns();
+        if (imported[i].isExternal()) entry.externalPath = csvImports[i].second;
+        tables[tableName] = move(imported[i]);
+    }
+
+    // Recreate secondary indexes and external tables
+    for (const string& line : catalogLines) {
+        stringstream ss(line);
+        string kind, indexName, tableName, columnName;
+        getline(ss, kind, ',');
+        if (kind == "EXTERNAL") {
+            string filePath;
+            getline(ss, tableName, ',');
+            getline(ss, filePath); // The rest of the line, commas included
+            if (catalog.count(tableName)) continue; // Found in the storage directory
+            try {
+                CSVFile file(filePath); // Only the header and a sample are read
+                CatalogEntry& entry = catalog[tableName];
+                entry.columns = file.getColumns();
+                entry.externalPath = filePath;
+            } catch (const exception& e) {
+                loadErrors.push_back(e.what());
+            }
+            continue;
+        }
+        getline(ss, indexName, ',');
+        getline(ss, tableName, ',');
+        getline(ss, columnName, ',');
+        if (kind != "INDEX") continue;
+        auto loaded = tables.find(tableName);
+        if (loaded != tables.end()) {
+            loaded->second.createIndex(indexName, columnName);
+        } else if (catalog.count(tableName)) {
+            catalog[tableName].indexes.emplace_back(indexName, columnName);
+        }
+    }
+    ++catalogVersion;
+
+    if (writeAheadLog) {
+        try {
+            openLog(fileSequence);
+        } catch (const exception& e) {
+            // Changes stay unlogged; the log file is left for inspection
+            loadErrors.push_back(e.what());
+        }
+    }
+}
+
+void Database::openLog(uint64_t fileSequence) {
+    _mkdir(storagePath.c_str());
+    unique_ptr<WriteAheadLog> opened(new WriteAheadLog(storagePath + "/wal.log"));
+    opened->advanceSequence(fileSequence + 1);
+
+    // Redo changes made since each table was last saved; the tables stay
+    // dirty, and the log keeps the records, until the next checkpoint
+    opened->replay([this](const LogRecord& record) {
+        try {
+            redo(record);
+        } catch (const exception& e) {
+            loadErrors.push_back(e.what());
+        }
+    });
+
+    log = move(opened);
+    for (auto& pair : tables) {
+        pair.second.setRedoLog(log.get());
+    }
+}
+
+void Database::redo(const LogRecord& record) {
+    if (record.type == LogRecordType::CREATE_TABLE) {
+        if (hasTable(record.tableName)) return; // Saved since
+        createTable(record.tableName, record.columns, record.storageMode);
+        tables[record.tableName].setLogSequence(record.sequence);
+        return;
+    }
+    Table* table = getTable(record.tableName);
+    if (!table || table->getLogSequence() >= record.sequence) return;
+    if (record.type == LogRecordType::DROP_TABLE) {
+        dropTable(record.tableName);
+    } else {
+        table->redo(record);
+    }
+}
+
+void Database::commitLog() {
+    if (log) log->commit();
+}
+
+bool Database::startCheckpoint() {
+    if (!log || checkpoint) return false;
+    commitLog();
+
+    unique_ptr<CheckpointJob> job(new CheckpointJob());
+    job->sequence = log->getNextSequence() - 1;
+    job->catalogDefinition = catalogDefinition();
+    for (auto& pair : tables) {
+        if (!pair.second.isDirty()) continue;
+        job->snapshots.push_back(pair.second.snapshot());
+        pair.second.markClean(); // Changes from here on dirty it again
+    }
+    if (job->snapshots.empty() && log->getSize() == 0) return false;
+    lastCheckpoint = chrono::steady_clock::now();
+
+    CheckpointJob* running = job.get();
+    string directory = storagePath;
+    size_t bytesPerSecond = checkpointBytesPerSecond;
+    job->worker = thread([running, directory, bytesPerSecond]() {
+        try {
+            writeCatalogFile(directory, running->catalogDefinition);
+            // Sleep whenever the bytes written get ahead of the rate limit
+            auto start = chrono::steady_clock::now();
+            uint64_t written = 0;
+            function<void(size_t)> throttle;
+            if (bytesPerSecond > 0) {
+                throttle = [&](size_t bytes) {
+                    written += bytes;
+                    chrono::duration<double> elapsed(static_cast<double>(written) / bytesPerSecond);
+                    this_thread::sleep_until(start + chrono::duration_cast<chrono::steady_clock::duration>(elapsed));
+                };
+            }
+            for (const auto& snapshot : running->snapshots) {
+                snapshot.saveToBinary(directory + "/" + snapshot.getName() + ".tbl", throttle);
+            }
+        } catch (const exception& e) {
+            running->error = e.what();
+        }
+        running->finished.store(true);
+    });
+    checkpoint = move(job);
+    return true;
+}
+
+void Database::finishCheckpoint(bool wait) {
+    if (!checkpoint || (!wait && !checkpoint->finished.load())) return;
+    checkpoint->worker.join();
+    unique_ptr<CheckpointJob> job = move(checkpoint);
+
+    if (!job->error.empty()) {
+        // The log keeps the records; the next checkpoint saves the tables again
+        for (const auto& snapshot : job->snapshots) {
+            auto it = tables.find(snapshot.getName());
+            if (it != tables.end()) it->second.markDirty();
         }
+        throw runtime_error("Checkpoint failed: " + job->error);
     }
+    for (const auto& snapshot : job->snapshots) {
+        catalog[snapshot.getName()].filePath = tableFilePath(snapshot.getName());
+    }
+    log->discardThrough(job->sequence);
+}
+
+void Database::checkpointIfDue() {
+    finishCheckpoint(false);
+    if (!log || checkpoint) return;
+    uint64_t logSize = log->getSize();
+    if (logSize >= checkpointLogBytes ||
+        (logSize > 0 && chrono::steady_clock::now() - lastCheckpoint >= checkpointInterval)) {
+        startCheckpoint();
+    }
+}
+
+void Database::close() {
+    if (!log) {
+        saveAllTables();
+        return;
+    }
+    commitLog();
+    finishCheckpoint(true);
+}
+
+void Database::saveTable(const string& name) {
+    auto it = tables.find(name);
+    if (it == tables.end()) return; // Unloaded tables are unchanged on disk
+    if (!it->second.isDirty()) return;
+    // Indexes first: replay only redoes index changes newer than the table file
+    writeCatalog();
+    writeTable(it->second);
+}
+
+void Database::writeTable(Table& table) {
+    _mkdir(storagePath.c_str());
+    table.saveToBinary(tableFilePath(table.getName()));
+    table.markClean();
+    catalog[table.getName()].filePath = tableFilePath(table.getName());
 }
 
 vector<string> Database::getTableNames() const {
     vector<string> names;
-    names.reserve(tables.size());
+    names.reserve(catalog.size());
 
-    for (const auto& pair : tables) {
+    for (const auto& pair : catalog) {
         names.push_back(pair.first);
     }
 
@@ -50,10 +413,98 @@ vector<string> Database::getTableNames() const {
 }
 
 void Database::saveAllTables() {
+    try {
+        finishCheckpoint(true);
+    } catch (const exception&) {
+        // Its tables are dirty again and are saved below
+    }
     // Create directory if not exists
     _mkdir(storagePath.c_str());
+    commitLog();
+    writeCatalog();
+    for (auto& pair : tables) {
+        if (pair.second.isDirty()) writeTable(pair.second);
+    }
+    // Every logged change is now in a table file
+    if (log) log->reset();
+}
+
+string Database::catalogDefinition() const {
+    // External tables, index definitions and ignored CSV files; the trees themselves are
+    // rebuilt on load
+    ostringstream definition;
+    for (const auto& pair : catalog) {
+        if (!pair.second.externalPath.empty()) {
+            definition << "EXTERNAL," << pair.first << "," << pair.second.externalPath << "\n";
+            continue;
+        }
+        auto loaded = tables.find(pair.first);
+        const auto& indexes = loaded != tables.end() ? loaded->second.getIndexDefinitions() : pair.second.indexes;
+        for (const auto& index : indexes) {
+            definition << "INDEX," << index.first << "," << pair.first << "," << index.second << "\n";
+        }
+    }
+    for (const string& name : ignoredCSVFiles) {
+        definition << "IGNORE," << name << "\n";
+    }
+    return definition.str();
+}
+
+void Database::writeCatalog() {
+    writeCatalogFile(storagePath, catalogDefinition());
+}
+
+// Runs on the checkpoint thread too, so it touches no Database state
+void Database::writeCatalogFile(const string& directory, const string& definition) {
+    _mkdir(directory.c_str());
+    string catalogPath = directory + "/catalog.def";
+    string tempPath = catalogPath + ".tmp";
+    {
+        ofstream catalogFile(tempPath);
+        catalogFile << definition;
+        if (!catalogFile.flush()) {
+            throw runtime_error("Cannot write catalog: " + tempPath);
+        }
+    }
+    if (!FileSync::syncFile(tempPath)) {
+        throw runtime_error("Cannot write catalog: " + tempPath);
+    }
+    error_code ec;
+    filesystem::rename(tempPath, catalogPath, ec);
+    if (ec) {
+        throw runtime_error("Cannot replace catalog " + catalogPath + ": " + ec.message());
+    }
+}
+
+bool Database::evictTable(const string& name) {
+    auto it = tables.find(name);
+    if (it == tables.end()) return false;
+
+    saveTable(name);
+    Table& table = it->second;
+    CatalogEntry& entry = catalog[name];
+    entry.columns = table.getColumns();
+    entry.indexes = table.getIndexDefinitions();
+    tables.erase(it);
+    ++catalogVersion;
+    return true;
+}
+
+size_t Database::evictColdTables() {
+    if (maxLoadedTables == 0 || tables.size() <= maxLoadedTables) return 0;
+    // A table being checkpointed must stay loaded: its file is not yet current
+    if (checkpoint) return 0;
+
+    // Least recently used first
+    vector<pair<size_t, string>> loaded;
     for (const auto& pair : tables) {
-        string filePath = storagePath + "/" + pair.first + ".csv";
-        pair.second.saveToCSV(filePath);
+        loaded.emplace_back(catalog[pair.first].lastUsed, pair.first);
+    }
+    sort(loaded.begin(), loaded.end());
+
+    size_t evicted = 0;
+    for (size_t i = 0; i + maxLoadedTables < loaded.size(); ++i) {
+        if (evictTable(loaded[i].second)) ++evicted;
     }
+    return evicted;
 }
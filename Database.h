@@ -2,26 +2,166 @@
 #pragma once
 #include <string>
 #include <map>
+#include <set>
 #include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
 #include "Table.h"
+#include "WriteAheadLog.h"
 
 using namespace std;
 
+// A table known to the database. Rows of a table stored on disk are only
+// loaded when getTable first asks for it, and cold tables can be evicted
+// again; the schema stays available either way.
+struct CatalogEntry {
+    vector<Column> columns;                 // Schema while the table is not loaded
+    string filePath;                        // .tbl holding the rows; empty until first saved
+    vector<pair<string, string>> indexes;   // (index, column) to recreate when loaded
+    string externalPath;                    // CSV queried in place (Table::attachCSV); empty otherwise
+    size_t lastUsed;                        // getTable tick, for LRU eviction
+
+    CatalogEntry() : lastUsed(0) {}
+};
+
+// A checkpoint in progress: snapshots of the tables that were dirty when it
+// started, written to their files by a background thread
+struct CheckpointJob {
+    uint64_t sequence;          // Last log record the snapshots reflect
+    vector<Table> snapshots;
+    string catalogDefinition;   // catalog.def contents at the start
+    thread worker;
+    atomic<bool> finished;
+    string error;               // Set by the worker if a write failed
+
+    CheckpointJob() : sequence(0), finished(false) {}
+    ~CheckpointJob() { if (worker.joinable()) worker.join(); }
+};
+
 class Database {
 private:
-    map<string, Table> tables;  // Changed to own Table, not pointer
+    map<string, Table> tables;  // Loaded tables
+    map<string, CatalogEntry> catalog; // Every table, loaded or not
+    set<string> ignoredCSVFiles;    // <storage>/<name>.csv of dropped external tables, kept in catalog.def
     string storagePath;
+    StorageMode defaultStorageMode; // Storage mode for tables loaded from disk
+    bool mapTableFiles;             // Load .tbl files as StorageMode::MAPPED
+    size_t catalogVersion;          // Bumped whenever tables are added or removed
+    size_t sortMemoryBudget;        // Bytes ORDER BY may buffer before spilling runs to disk
+    vector<string> loadErrors;      // Tables skipped by the last loadAllTables
+    size_t maxLoadedTables;         // evictColdTables keeps at most this many (0 = no limit)
+    size_t useClock;
+    bool writeAheadLog;             // Open wal.log on loadAllTables and log every change
+    unique_ptr<WriteAheadLog> log;
+    unique_ptr<CheckpointJob> checkpoint;   // Running or finished, not yet completed
+    uint64_t checkpointLogBytes;            // checkpointIfDue thresholds
+    chrono::seconds checkpointInterval;
+    size_t checkpointBytesPerSecond;        // Checkpoint write rate limit (0 = none)
+    chrono::steady_clock::time_point lastCheckpoint;
+
+    Table* loadTable(const string& name, CatalogEntry& entry);
+    void openLog(uint64_t fileSequence);
+    void redo(const LogRecord& record);
+    string catalogDefinition() const;
+    void writeCatalog();
+    static void writeCatalogFile(const string& directory, const string& definition);
+    void writeTable(Table& table);
+    string tableFilePath(const string& name) const { return storagePath + "/" + name + ".tbl"; }
 
 public:
-    Database(const string& path = "data") : storagePath(path) {}
+    Database(const string& path = "data")
+        : storagePath(path), defaultStorageMode(StorageMode::ROW), mapTableFiles(false), catalogVersion(0),
+          sortMemoryBudget(256 * 1024 * 1024), maxLoadedTables(0), useClock(0), writeAheadLog(false),
+          checkpointLogBytes(64 * 1024 * 1024), checkpointInterval(300), checkpointBytesPerSecond(0),
+          lastCheckpoint(chrono::steady_clock::now()) {}
+
+    const string& getStoragePath() const { return storagePath; }
+    // Scratch files (e.g. sort runs) live here
+    string getTempPath() const { return storagePath + "/tmp"; }
 
-    void createTable(const string& name, const vector<Column>& cols);
-    Table* getTable(const string& name);  // Returns pointer for compatibility
+    void setSortMemoryBudget(size_t bytes) { sortMemoryBudget = bytes; }
+    size_t getSortMemoryBudget() const { return sortMemoryBudget; }
+
+    // Lets tables cache Table* lookups (e.g. foreign key targets) safely
+    size_t getCatalogVersion() const { return catalogVersion; }
+
+    void setDefaultStorageMode(StorageMode mode) { defaultStorageMode = mode; }
+    StorageMode getDefaultStorageMode() const { return defaultStorageMode; }
+
+    // Memory-map table files instead of reading them (see Table::mapFromBinary).
+    // Takes effect on the next loadAllTables.
+    void setMapTableFiles(bool map) { mapTableFiles = map; }
+    bool getMapTableFiles() const { return mapTableFiles; }
+
+    // Log DDL and row changes to <storage>/wal.log (see WriteAheadLog) and
+    // replay the log on load. Takes effect on the next loadAllTables.
+    void setWriteAheadLog(bool enabled) { writeAheadLog = enabled; }
+    bool getWriteAheadLog() const { return writeAheadLog; }
+    bool isLogging() const { return log != nullptr; }
+    // Makes every change logged so far durable with a single sync; callers
+    // batch statements and commit once (group commit)
+    void commitLog();
+
+    // Background checkpoints (write-ahead log on; call between statements).
+    // startCheckpoint snapshots the dirty tables (no rows are copied, see
+    // Table::snapshot) and returns at once; a worker thread writes them, and
+    // finishCheckpoint then drops the log records they cover. Tables stay
+    // usable throughout, but none are evicted.
+    bool startCheckpoint(); // False if one is running or there is nothing to save
+    // Completes a finished checkpoint, or waits for a running one. Throws
+    // runtime_error if it failed; its tables are saved again by the next one.
+    void finishCheckpoint(bool wait);
+    bool isCheckpointRunning() const { return checkpoint != nullptr; }
+    // Finishes a completed checkpoint, and starts one once the log reaches
+    // the size threshold or the interval has passed since the last one
+    void checkpointIfDue();
+    void setCheckpointThresholds(uint64_t logBytes, chrono::seconds interval) {
+        checkpointLogBytes = logBytes;
+        checkpointInterval = interval;
+    }
+    void setCheckpointRate(size_t bytesPerSecond) { checkpointBytesPerSecond = bytesPerSecond; }
+    // For shutdown: commits the log and waits for a running checkpoint
+    // (replay on the next load covers the rest); without the log, saves
+    // every table
+    void close();
+
+    void createTable(const string& name, const vector<Column>& cols, StorageMode mode = StorageMode::ROW);
+    // Read-only table over a plain CSV file, queried in place (see CSVFile).
+    // It is recorded in catalog.def at once rather than in the log. Throws
+    // runtime_error if the name is taken or the file cannot be opened.
+    void createExternalTable(const string& name, const string& filePath);
+    // Loads the table's rows on first use; throws runtime_error if its file is corrupt
+    Table* getTable(const string& name);
+    bool hasTable(const string& name) const { return catalog.count(name) > 0; }
+    bool isTableLoaded(const string& name) const { return tables.count(name) > 0; }
+    // Schema without loading the table, or nullptr
+    const vector<Column>* getTableColumns(const string& name) const;
+    // Deletes the table's files; an external table's CSV file is kept
     void dropTable(const string& name);
+    Table* findTableByIndex(const string& indexName); // Table owning the named index, or nullptr
 
+    // Tables are stored as <name>.tbl (see TableFile). Loading reads only
+    // their schemas; a <name>.csv with no .tbl beside it is imported right
+    // away and the next save writes the .tbl if it was written by
+    // Table::saveToCSV, and is otherwise opened as an external table.
+    // Saving writes only dirty tables (see Table::isDirty), each through a
+    // temp file renamed over the old one. With the write-ahead log on,
+    // saveAllTables is a checkpoint: once every table is saved the log is
+    // emptied.
     void loadAllTables();
     void saveAllTables();
+    void saveTable(const string& name);
+    const vector<string>& getLoadErrors() const { return loadErrors; }
     vector<string> getTableNames() const;
 
-
+    // Eviction writes a dirty table back to its file and drops its rows
+    // until the next getTable. It invalidates
+    // Table* pointers, so only call it between statements.
+    bool evictTable(const string& name);
+    void setMaxLoadedTables(size_t count) { maxLoadedTables = count; }
+    size_t getMaxLoadedTables() const { return maxLoadedTables; }
+    // Evicts least recently used tables beyond the limit; returns how many
+    size_t evictColdTables();
 };
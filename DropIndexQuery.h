@@ -0,0 +1,13 @@
+// include/DropIndexQuery.h
+#pragma once
+#include "Query.h"
+#include <string>
+using namespace std;
+
+class DropIndexQuery : public Query {
+public:
+    string indexName;
+    string tableName; // Optional (DROP INDEX name ON table); empty means search all tables
+
+    DropIndexQuery() { type = QueryType::DROP_INDEX; }
+};
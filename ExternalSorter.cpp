@@ -0,0 +1,168 @@
+// src/ExternalSorter.cpp
+#include "ExternalSorter.h"
+#include "BinaryIO.h"
+#include <filesystem>
+#include <fstream>
+#include <queue>
+#include <memory>
+#include <atomic>
+#include <random>
+#include <stdexcept>
+
+using namespace std;
+
+ExternalSorter::ExternalSorter(const vector<SortKeySpec>& s, size_t budget, const string& dir)
+    : specs(s), memoryBudget(budget), tempDirectory(dir), bufferedBytes(0) {}
+
+ExternalSorter::~ExternalSorter() {
+    removeRuns();
+}
+
+size_t ExternalSorter::estimateSize(const Row& row) {
+    size_t bytes = sizeof(Row) + row.values.capacity() * sizeof(Value);
+    for (const auto& v : row.values) {
+        // Short strings live inline; longer ones own a heap block
+        if (v.data.capacity() > 15) bytes += v.data.capacity() + 1;
+        bytes += 18; // Sort key bytes per column, upper bound for non-text values
+    }
+    return bytes;
+}
+
+void ExternalSorter::add(Row&& row) {
+    bufferedBytes += estimateSize(row);
+    buffer.push_back(move(row));
+    if (bufferedBytes >= memoryBudget && buffer.size() > 1) {
+        spill();
+    }
+}
+
+string ExternalSorter::newRunPath() {
+    // Unique per process and per run, so sorters never share a file
+    static const string processToken = to_string(random_device()());
+    static atomic<unsigned long long> nextRunId(0);
+
+    filesystem::create_directories(tempDirectory);
+    return tempDirectory + "/sort_" + processToken + "_" + to_string(nextRunId++) + ".run";
+}
+
+void ExternalSorter::spill() {
+    string path = newRunPath();
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) {
+        throw runtime_error("Cannot create sort run file: " + path);
+    }
+    runFiles.push_back(path);
+
+    // Each record is the encoded sort key followed by the row, so the merge
+    // compares keys without re-encoding
+    vector<size_t> order = SortKey::sortedOrder(buffer, specs);
+    string key;
+    for (size_t i : order) {
+        SortKey::encode(buffer[i], specs, key);
+        BinaryIO::writeString(out, key);
+        BinaryIO::writeRow(out, buffer[i]);
+    }
+    if (!out.flush()) {
+        throw runtime_error("Cannot write sort run file: " + path);
+    }
+
+    vector<Row>().swap(buffer);
+    bufferedBytes = 0;
+}
+
+void ExternalSorter::mergeRuns(const vector<string>& paths, const function<void(string&, Row&)>& emit) {
+    // One cursor per run holding its current record
+    struct Cursor {
+        ifstream in;
+        string key;
+        Row row;
+    };
+    vector<unique_ptr<Cursor>> cursors;
+    auto advance = [](Cursor& c) {
+        if (!BinaryIO::readString(c.in, c.key)) return false;
+        if (!BinaryIO::readRow(c.in, c.row)) {
+            throw runtime_error("Corrupt sort run file");
+        }
+        return true;
+    };
+
+    // Min-heap on (key, run); runs hold consecutive input ranges, so the run
+    // index breaks ties in input order
+    auto greater = [&](size_t a, size_t b) {
+        int c = SortKey::compare(cursors[a]->key, cursors[b]->key);
+        return c != 0 ? c > 0 : a > b;
+    };
+    priority_queue<size_t, vector<size_t>, decltype(greater)> heap(greater);
+
+    for (size_t run = 0; run < paths.size(); ++run) {
+        unique_ptr<Cursor> cursor(new Cursor());
+        cursor->in.open(paths[run], ios::binary);
+        if (!cursor->in) {
+            throw runtime_error("Cannot open sort run file: " + paths[run]);
+        }
+        cursors.push_back(move(cursor));
+        if (advance(*cursors.back())) heap.push(run);
+    }
+
+    while (!heap.empty()) {
+        size_t top = heap.top();
+        heap.pop();
+        emit(cursors[top]->key, cursors[top]->row);
+        if (advance(*cursors[top])) heap.push(top);
+    }
+}
+
+void ExternalSorter::finish(const function<void(Row&&)>& consumer) {
+    if (runFiles.empty()) {
+        // Everything fit the budget: plain in-memory sort
+        SortKey::sortRows(buffer, specs);
+        for (auto& row : buffer) consumer(move(row));
+        vector<Row>().swap(buffer);
+        bufferedBytes = 0;
+        return;
+    }
+    if (!buffer.empty()) spill();
+
+    // Merge groups of consecutive runs into longer runs until one pass can
+    // merge them all without holding too many files open. runFiles always
+    // lists every file on disk, so removeRuns cleans up after an exception:
+    // a merged run is appended as soon as it is created, and a group is
+    // dropped from the front once merged.
+    while (runFiles.size() > MAX_MERGE_FAN_IN) {
+        size_t passRuns = runFiles.size();
+        while (passRuns > 0) {
+            size_t groupSize = min(passRuns, MAX_MERGE_FAN_IN);
+            vector<string> group(runFiles.begin(), runFiles.begin() + groupSize);
+            string path = newRunPath();
+            runFiles.push_back(path);
+            ofstream out(path, ios::binary | ios::trunc);
+            if (!out) {
+                throw runtime_error("Cannot create sort run file: " + path);
+            }
+            mergeRuns(group, [&](string& key, Row& row) {
+                BinaryIO::writeString(out, key);
+                BinaryIO::writeRow(out, row);
+            });
+            if (!out.flush()) {
+                throw runtime_error("Cannot write sort run file: " + path);
+            }
+            runFiles.erase(runFiles.begin(), runFiles.begin() + groupSize);
+            passRuns -= groupSize;
+            for (const auto& done : group) {
+                error_code ec;
+                filesystem::remove(done, ec);
+            }
+        }
+    }
+
+    mergeRuns(runFiles, [&](string&, Row& row) { consumer(move(row)); });
+    removeRuns();
+}
+
+void ExternalSorter::removeRuns() {
+    for (const auto& path : runFiles) {
+        error_code ec;
+        filesystem::remove(path, ec);
+    }
+    runFiles.clear();
+}
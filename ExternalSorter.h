@@ -0,0 +1,49 @@
+// include/ExternalSorter.h
+#pragma once
+#include <vector>
+#include <string>
+#include <functional>
+#include "Row.h"
+#include "SortKey.h"
+
+using namespace std;
+
+// Most run files merged (and held open) at once
+const size_t MAX_MERGE_FAN_IN = 64;
+
+// ORDER BY for inputs larger than memory. Rows are buffered until their
+// estimated size reaches the memory budget, then sorted and written to a run
+// file in the temp directory. finish() k-way merges the runs and streams rows
+// to the consumer in sorted order. When everything fits the budget nothing
+// touches disk. Ties keep their input order, as with SortKey::sortRows.
+class ExternalSorter {
+public:
+    ExternalSorter(const vector<SortKeySpec>& specs, size_t memoryBudget, const string& tempDirectory);
+    ~ExternalSorter();
+
+    ExternalSorter(const ExternalSorter&) = delete;
+    ExternalSorter& operator=(const ExternalSorter&) = delete;
+
+    void add(Row&& row);
+
+    // Streams every added row in sorted order; the sorter is empty afterwards
+    void finish(const function<void(Row&&)>& consumer);
+
+    size_t runCount() const { return runFiles.size(); }
+
+    // Rough heap footprint of a buffered row (values, text payloads, sort key)
+    static size_t estimateSize(const Row& row);
+
+private:
+    vector<SortKeySpec> specs;
+    size_t memoryBudget;
+    string tempDirectory;
+    vector<Row> buffer;
+    size_t bufferedBytes;
+    vector<string> runFiles;
+
+    string newRunPath();
+    void spill();
+    void mergeRuns(const vector<string>& paths, const function<void(string&, Row&)>& emit);
+    void removeRuns();
+};
@@ -0,0 +1,20 @@
+// include/FileSync.h
+#pragma once
+#include <string>
+#include <cstdio>
+
+using namespace std;
+
+// Forces written data out of the OS cache onto stable storage. Without this a
+// crash can lose writes that already "succeeded", or leave a rename durable
+// before the data it publishes.
+class FileSync {
+public:
+    // Return false if the data could not be synced
+    static bool syncFile(FILE* file);   // Flushes the stdio buffer first
+    static bool syncFile(const string& path);
+
+    // Makes creates, renames and removals in the directory durable (no-op on
+    // Windows, where the file system journals them)
+    static void syncDirectory(const string& path);
+};
@@ -0,0 +1,239 @@
+// src/HashAggregator.cpp
+#include "HashAggregator.h"
+#include "ThreadPool.h"
+#include <algorithm>
+
+using namespace std;
+
+size_t GroupKeyHash::operator()(const vector<Value>& key) const {
+    size_t h = 0;
+    for (const auto& v : key) {
+        h ^= v.hash() + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+    return h;
+}
+
+bool GroupKeyEqual::operator()(const vector<Value>& a, const vector<Value>& b) const {
+    if (a.size() != b.size()) return false;
+    ValueEqual equal;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (!equal(a[i], b[i])) return false;
+    }
+    return true;
+}
+
+HashAggregator::HashAggregator(const vector<size_t>& groupCols, const vector<AggregateSpec>& aggs)
+    : groupColumns(groupCols), aggregates(aggs), scratchKey(groupCols.size()) {}
+
+bool HashAggregator::parseFunction(const string& function, const string& column, AggregateKind& kind) {
+    if (function == "COUNT") kind = column == "*" ? AggregateKind::COUNT_STAR : AggregateKind::COUNT;
+    else if (function == "SUM") kind = AggregateKind::SUM;
+    else if (function == "AVG") kind = AggregateKind::AVG;
+    else if (function == "MIN") kind = AggregateKind::MIN;
+    else if (function == "MAX") kind = AggregateKind::MAX;
+    else return false;
+    return true;
+}
+
+size_t HashAggregator::findOrAddGroup(const vector<Value>& key) {
+    auto it = groupIndex.find(key);
+    if (it != groupIndex.end()) return it->second;
+
+    size_t group = keys.size();
+    keys.push_back(key);
+    groupIndex.emplace(key, group);
+    states.resize(states.size() + aggregates.size());
+    return group;
+}
+
+void HashAggregator::add(const Row& r) {
+    for (size_t i = 0; i < groupColumns.size(); ++i) {
+        size_t col = groupColumns[i];
+        scratchKey[i] = col < r.values.size() ? r.values[col] : Value::createNull(DataType::UNKNOWN);
+    }
+
+    size_t group = findOrAddGroup(scratchKey);
+    AggregateState* groupStates = states.data() + group * aggregates.size();
+    for (size_t i = 0; i < aggregates.size(); ++i) {
+        accumulate(groupStates[i], aggregates[i], r);
+    }
+}
+
+void HashAggregator::mergeGroup(const HashAggregator& other, size_t otherGroup) {
+    size_t group = findOrAddGroup(other.keys[otherGroup]);
+    AggregateState* into = states.data() + group * aggregates.size();
+    const AggregateState* from = other.states.data() + otherGroup * aggregates.size();
+    for (size_t i = 0; i < aggregates.size(); ++i) {
+        mergeState(into[i], from[i]);
+    }
+}
+
+void HashAggregator::merge(const HashAggregator& other) {
+    for (size_t group = 0; group < other.keys.size(); ++group) {
+        mergeGroup(other, group);
+    }
+}
+
+void HashAggregator::mergeState(AggregateState& into, const AggregateState& from) {
+    if (from.count == 0) return;
+    if (into.count == 0) {
+        into.minVal = from.minVal;
+        into.maxVal = from.maxVal;
+    } else {
+        if (from.minVal < into.minVal) into.minVal = from.minVal;
+        if (from.maxVal > into.maxVal) into.maxVal = from.maxVal;
+    }
+    into.sum += from.sum;
+    into.count += from.count;
+}
+
+vector<vector<size_t>> HashAggregator::partitionGroups(size_t partitionCount) const {
+    GroupKeyHash hasher;
+    vector<vector<size_t>> partitions(partitionCount);
+    for (size_t group = 0; group < keys.size(); ++group) {
+        partitions[hasher(keys[group]) % partitionCount].push_back(group);
+    }
+    return partitions;
+}
+
+void HashAggregator::accumulate(AggregateState& state, const AggregateSpec& spec, const Row& r) {
+    if (spec.kind == AggregateKind::COUNT_STAR) {
+        ++state.count;
+        return;
+    }
+    if (spec.column >= r.values.size()) return;
+    const Value& v = r.values[spec.column];
+    if (spec.kind == AggregateKind::COUNT) {
+        if (!v.isNull) ++state.count;
+        return;
+    }
+
+    // SUM/AVG/MIN/MAX skip NULL and non-numeric values
+    double val;
+    if (!v.tryGetDouble(val)) return;
+    if (state.count == 0) {
+        state.minVal = val;
+        state.maxVal = val;
+    } else {
+        if (val < state.minVal) state.minVal = val;
+        if (val > state.maxVal) state.maxVal = val;
+    }
+    state.sum += val;
+    ++state.count;
+}
+
+double HashAggregator::result(const AggregateState& state, AggregateKind kind) {
+    switch (kind) {
+        case AggregateKind::COUNT_STAR:
+        case AggregateKind::COUNT: return static_cast<double>(state.count);
+        case AggregateKind::SUM: return state.sum;
+        case AggregateKind::AVG: return state.count > 0 ? state.sum / state.count : 0.0;
+        case AggregateKind::MIN: return state.minVal;
+        case AggregateKind::MAX: return state.maxVal;
+    }
+    return 0.0;
+}
+
+void HashAggregator::appendRows(vector<Row>& out) const {
+    for (size_t group = 0; group < keys.size(); ++group) {
+        Row row;
+        row.values.reserve(groupColumns.size() + aggregates.size());
+        row.values = keys[group];
+        const AggregateState* groupStates = states.data() + group * aggregates.size();
+        for (size_t i = 0; i < aggregates.size(); ++i) {
+            row.values.push_back(Value::fromFloat(HashAggregator::result(groupStates[i], aggregates[i].kind)));
+        }
+        out.push_back(move(row));
+    }
+}
+
+void HashAggregator::sortByKey(vector<Row>& rows, size_t keyCount) {
+    // Order groups by key, NULLs first, then typed comparison per key column
+    sort(rows.begin(), rows.end(), [&](const Row& a, const Row& b) {
+        for (size_t i = 0; i < keyCount; ++i) {
+            const Value& ka = a.values[i];
+            const Value& kb = b.values[i];
+            if (ka.isNull != kb.isNull) return ka.isNull;
+            if (ka.isNull) continue;
+            int c = ka.compare(kb);
+            if (c != 0) return c < 0;
+        }
+        return false;
+    });
+}
+
+vector<Row> HashAggregator::finish() const {
+    vector<Row> result;
+    result.reserve(keys.size());
+    appendRows(result);
+    sortByKey(result, groupColumns.size());
+    return result;
+}
+
+void HashAggregator::addInParallel(vector<HashAggregator>& partials, const vector<Row>& rows) {
+    // Every task aggregates one contiguous slice into its own partial table
+    size_t slices = partials.size();
+    size_t morsels = (rows.size() + MORSEL_SIZE - 1) / MORSEL_SIZE;
+    if (morsels < slices) slices = morsels;
+    if (slices <= 1) {
+        for (const auto& row : rows) partials[0].add(row);
+        return;
+    }
+
+    size_t sliceSize = (rows.size() + slices - 1) / slices;
+    ThreadPool::instance().parallelFor(slices, [&](size_t s) {
+        size_t begin = s * sliceSize;
+        size_t end = min(rows.size(), begin + sliceSize);
+        for (size_t r = begin; r < end; ++r) partials[s].add(rows[r]);
+    });
+}
+
+vector<Row> HashAggregator::mergePartials(vector<HashAggregator>& partials) {
+    // Below this many groups one task merges all partials; above it the merge is partitioned
+    const size_t RADIX_MERGE_THRESHOLD = 4096;
+    const size_t PARTITION_COUNT = 64;
+
+    size_t largestPartial = 0;
+    for (const auto& partial : partials) largestPartial = max(largestPartial, partial.groupCount());
+    if (partials.size() == 1 || largestPartial < RADIX_MERGE_THRESHOLD) {
+        for (size_t s = 1; s < partials.size(); ++s) partials[0].merge(partials[s]);
+        return partials[0].finish();
+    }
+
+    // Radix-partition each partial's groups by key hash...
+    size_t slices = partials.size();
+    vector<vector<vector<size_t>>> partitioned(slices);
+    ThreadPool::instance().parallelFor(slices, [&](size_t s) {
+        partitioned[s] = partials[s].partitionGroups(PARTITION_COUNT);
+    });
+
+    // ...and merge each partition independently; a group lives in exactly one partition
+    const HashAggregator& shape = partials[0];
+    vector<HashAggregator> merged(PARTITION_COUNT, HashAggregator(shape.groupColumns, shape.aggregates));
+    ThreadPool::instance().parallelFor(PARTITION_COUNT, [&](size_t p) {
+        for (size_t s = 0; s < slices; ++s) {
+            for (size_t group : partitioned[s][p]) merged[p].mergeGroup(partials[s], group);
+        }
+    });
+
+    vector<Row> result;
+    for (const auto& partition : merged) partition.appendRows(result);
+    sortByKey(result, shape.groupColumns.size());
+    return result;
+}
+
+vector<Row> HashAggregator::aggregate(const vector<Row>& rows, const vector<size_t>& groupColumns,
+                                      const vector<AggregateSpec>& aggregates) {
+    size_t slices = ThreadPool::instance().getDegreeOfParallelism();
+    size_t morsels = (rows.size() + MORSEL_SIZE - 1) / MORSEL_SIZE;
+    if (morsels < slices) slices = morsels;
+    if (slices <= 1) {
+        HashAggregator aggregator(groupColumns, aggregates);
+        for (const auto& row : rows) aggregator.add(row);
+        return aggregator.finish();
+    }
+
+    vector<HashAggregator> partials(slices, HashAggregator(groupColumns, aggregates));
+    addInParallel(partials, rows);
+    return mergePartials(partials);
+}
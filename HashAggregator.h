@@ -0,0 +1,95 @@
+// include/HashAggregator.h
+#pragma once
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include "Value.h"
+#include "Row.h"
+
+using namespace std;
+
+enum class AggregateKind {
+    COUNT_STAR,
+    COUNT,
+    SUM,
+    AVG,
+    MIN,
+    MAX
+};
+
+struct AggregateSpec {
+    AggregateKind kind;
+    size_t column;      // Input column (unused for COUNT(*))
+};
+
+// Running state of one aggregate within one group
+struct AggregateState {
+    int64_t count;      // Rows (COUNT(*)), non-NULL values (COUNT) or numeric values (others)
+    double sum;
+    double minVal;
+    double maxVal;
+
+    AggregateState() : count(0), sum(0.0), minVal(0.0), maxVal(0.0) {}
+};
+
+// Composite group key hashing; NULLs group together (see ValueEqual)
+struct GroupKeyHash {
+    size_t operator()(const vector<Value>& key) const;
+};
+
+struct GroupKeyEqual {
+    bool operator()(const vector<Value>& a, const vector<Value>& b) const;
+};
+
+// GROUP BY / aggregate evaluation in one pass over the input. Only the group
+// keys and one AggregateState per (group, aggregate) are kept, so memory grows
+// with the number of groups rather than the number of rows.
+class HashAggregator {
+public:
+    HashAggregator(const vector<size_t>& groupColumns, const vector<AggregateSpec>& aggregates);
+
+    // Maps "SUM"/"COUNT"/... (and the "*" column of COUNT(*)) to an AggregateKind
+    static bool parseFunction(const string& function, const string& column, AggregateKind& kind);
+
+    void add(const Row& r);
+    size_t groupCount() const { return keys.size(); }
+
+    // Folds another aggregator's partial states (same groups and aggregates) into this one
+    void merge(const HashAggregator& other);
+
+    // One row per group, ordered by group key: the key values followed by
+    // one FLOAT value per aggregate
+    vector<Row> finish() const;
+
+    // Aggregates 'rows' on the thread pool: each task aggregates a slice into
+    // its own partial table, then the partials are merged. With many groups
+    // the partial groups are radix-partitioned by hash so every partition is
+    // merged by a separate task. Returns the same rows as finish().
+    static vector<Row> aggregate(const vector<Row>& rows, const vector<size_t>& groupColumns,
+                                 const vector<AggregateSpec>& aggregates);
+
+    // The two phases of aggregate() for streamed input: addInParallel folds
+    // one batch into the partial tables (one slice per partial), and
+    // mergePartials combines them once the input is exhausted
+    static void addInParallel(vector<HashAggregator>& partials, const vector<Row>& rows);
+    static vector<Row> mergePartials(vector<HashAggregator>& partials);
+
+private:
+    vector<size_t> groupColumns;
+    vector<AggregateSpec> aggregates;
+    unordered_map<vector<Value>, size_t, GroupKeyHash, GroupKeyEqual> groupIndex;
+    vector<vector<Value>> keys;
+    vector<AggregateState> states;  // Group-major: states[group * aggregates.size() + i]
+    vector<Value> scratchKey;       // Reused for lookups so existing groups cost no allocation
+
+    size_t findOrAddGroup(const vector<Value>& key);
+    void mergeGroup(const HashAggregator& other, size_t otherGroup);
+    vector<vector<size_t>> partitionGroups(size_t partitionCount) const;
+    void appendRows(vector<Row>& out) const;
+    static void sortByKey(vector<Row>& rows, size_t keyCount);
+
+    static void accumulate(AggregateState& state, const AggregateSpec& spec, const Row& r);
+    static void mergeState(AggregateState& into, const AggregateState& from);
+    static double result(const AggregateState& state, AggregateKind kind);
+};
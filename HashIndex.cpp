@@ -0,0 +1,52 @@
+// src/HashIndex.cpp
+#include "HashIndex.h"
+#include <algorithm>
+
+using namespace std;
+
+void HashIndex::insert(const Value& key, size_t rowId) {
+    if (key.isNull) return;
+    entries.emplace(key, rowId);
+}
+
+void HashIndex::erase(const Value& key, size_t rowId) {
+    if (key.isNull) return;
+    auto range = entries.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == rowId) {
+            entries.erase(it);
+            return;
+        }
+    }
+}
+
+void HashIndex::renumber(const vector<size_t>& erasedRowIds) {
+    if (erasedRowIds.empty()) return;
+    for (auto& entry : entries) {
+        entry.second -= lower_bound(erasedRowIds.begin(), erasedRowIds.end(), entry.second) - erasedRowIds.begin();
+    }
+}
+
+bool HashIndex::contains(const Value& key) const {
+    if (key.isNull) return false;
+    return entries.find(key) != entries.end();
+}
+
+bool HashIndex::containsOtherThan(const Value& key, size_t excludeRowId) const {
+    if (key.isNull) return false;
+    auto range = entries.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second != excludeRowId) return true;
+    }
+    return false;
+}
+
+vector<size_t> HashIndex::find(const Value& key) const {
+    vector<size_t> rowIds;
+    if (key.isNull) return rowIds;
+    auto range = entries.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        rowIds.push_back(it->second);
+    }
+    return rowIds;
+}
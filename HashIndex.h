@@ -0,0 +1,34 @@
+// include/HashIndex.h
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include "Value.h"
+
+using namespace std;
+
+// Hash index over one column: typed key -> row ids. NULL keys are never
+// indexed, matching SQL where NULL does not collide with anything.
+class HashIndex {
+private:
+    size_t columnIndex;
+    unordered_multimap<Value, size_t, ValueHash, ValueEqual> entries;
+
+public:
+    HashIndex() : columnIndex(0) {}
+    explicit HashIndex(size_t col) : columnIndex(col) {}
+
+    size_t getColumnIndex() const { return columnIndex; }
+    size_t size() const { return entries.size(); }
+
+    void insert(const Value& key, size_t rowId);
+    void erase(const Value& key, size_t rowId);
+    void clear() { entries.clear(); }
+    void reserve(size_t n) { entries.reserve(n); }
+    // Shift row ids down past the erased rows (sorted); their keys must already be erased
+    void renumber(const vector<size_t>& erasedRowIds);
+
+    bool contains(const Value& key) const;
+    // True if the key is held by any row other than excludeRowId
+    bool containsOtherThan(const Value& key, size_t excludeRowId) const;
+    vector<size_t> find(const Value& key) const;
+};
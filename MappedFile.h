@@ -0,0 +1,32 @@
+// include/MappedFile.h
+#pragma once
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+// Read-only memory mapping of a whole file. The OS loads pages on first
+// access and shares them, through the page cache, with every process that
+// maps the same file.
+class MappedFile {
+public:
+    // Throws runtime_error if the file cannot be opened or mapped
+    explicit MappedFile(const string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    const char* base;
+    size_t length;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+};
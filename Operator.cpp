@@ -0,0 +1,292 @@
+// src/Operator.cpp
+#include "Operator.h"
+#include "Table.h"
+#include "ThreadPool.h"
+#include <algorithm>
+
+using namespace std;
+
+void scanTable(const Table& table, const Condition& where, const vector<size_t>& columns, Operator& consumer) {
+    if (!consumer.done()) {
+        table.scanRows(where, columns, [&](vector<Row>& batch) {
+            consumer.push(batch);
+            return !consumer.done();
+        });
+    }
+    consumer.finish();
+}
+
+// Hash key for a join value. When one join column is numeric and the other is
+// text, Value::compare compares the text numerically, so text that parses as a
+// number is keyed as that number.
+static Value joinKey(const Value& v, bool mixedKeyClasses) {
+    double d;
+    if (mixedKeyClasses && !v.isNumeric() && Value::parseDouble(v.data, d)) {
+        return Value::fromFloat(d);
+    }
+    return v;
+}
+
+HashJoinOperator::HashJoinOperator(vector<Row> rows, size_t probeCol, size_t buildCol,
+                                   bool mixed, const string& type,
+                                   const vector<Column>& probeColumns, const vector<Column>& buildColumns)
+    : buildRows(move(rows)), probeColumn(probeCol), joinType(type), mixedKeyClasses(mixed) {
+    for (const auto& col : probeColumns) probeTypes.push_back(col.type);
+    for (const auto& col : buildColumns) buildTypes.push_back(col.type);
+
+    table.reserve(buildRows.size());
+    for (size_t i = 0; i < buildRows.size(); ++i) {
+        const Row& row = buildRows[i];
+        if (buildCol >= row.values.size() || row.values[buildCol].isNull) continue;
+        table[joinKey(row.values[buildCol], mixedKeyClasses)].push_back(i);
+    }
+    if (joinType == "RIGHT") buildMatched.assign(buildRows.size(), false);
+}
+
+void HashJoinOperator::push(vector<Row>& batch) {
+    vector<Row> out;
+    auto merge = [&](Row& probeRow, const Row& buildRow, bool lastUse) {
+        Row merged;
+        merged.values.reserve(probeRow.values.size() + buildRow.values.size());
+        if (lastUse) {
+            merged.values = move(probeRow.values);
+        } else {
+            merged.values = probeRow.values;
+        }
+        merged.values.insert(merged.values.end(), buildRow.values.begin(), buildRow.values.end());
+        out.push_back(move(merged));
+    };
+
+    for (auto& probeRow : batch) {
+        const vector<size_t>* matches = nullptr;
+        if (probeColumn < probeRow.values.size() && !probeRow.values[probeColumn].isNull) {
+            auto it = table.find(joinKey(probeRow.values[probeColumn], mixedKeyClasses));
+            if (it != table.end()) matches = &it->second;
+        }
+
+        if (matches) {
+            // The probe row is copied for all but its last match
+            for (size_t m = 0; m < matches->size(); ++m) {
+                size_t buildIdx = (*matches)[m];
+                if (!buildMatched.empty()) buildMatched[buildIdx] = true;
+                merge(probeRow, buildRows[buildIdx], m + 1 == matches->size());
+            }
+        } else if (joinType == "LEFT") {
+            // Unmatched probe row padded with NULLs for the build columns
+            Row padded;
+            padded.values = move(probeRow.values);
+            for (DataType t : buildTypes) padded.values.push_back(Value::createNull(t));
+            out.push_back(move(padded));
+        }
+
+        if (out.size() >= MORSEL_SIZE) {
+            emit(out);
+            out.clear();
+        }
+    }
+    emit(out);
+}
+
+void HashJoinOperator::finish() {
+    if (joinType == "RIGHT") {
+        // Unmatched build rows with NULLs for every probe column
+        vector<Row> out;
+        for (size_t i = 0; i < buildRows.size(); ++i) {
+            if (buildMatched[i]) continue;
+            Row padded;
+            padded.values.reserve(probeTypes.size() + buildRows[i].values.size());
+            for (DataType t : probeTypes) padded.values.push_back(Value::createNull(t));
+            padded.values.insert(padded.values.end(), buildRows[i].values.begin(), buildRows[i].values.end());
+            out.push_back(move(padded));
+            if (out.size() >= MORSEL_SIZE) {
+                emit(out);
+                out.clear();
+            }
+        }
+        emit(out);
+    }
+    Operator::finish();
+}
+
+LeftBuildHashJoinOperator::LeftBuildHashJoinOperator(vector<Row> rows, size_t leftCol, size_t rightCol,
+                                                     bool mixed, const string& type,
+                                                     const vector<Column>& leftColumns)
+    : leftRows(move(rows)), rightColumn(rightCol), joinType(type), mixedKeyClasses(mixed) {
+    for (const auto& col : leftColumns) leftTypes.push_back(col.type);
+
+    table.reserve(leftRows.size());
+    for (size_t i = 0; i < leftRows.size(); ++i) {
+        const Row& row = leftRows[i];
+        if (leftCol >= row.values.size() || row.values[leftCol].isNull) continue;
+        table[joinKey(row.values[leftCol], mixedKeyClasses)].push_back(i);
+    }
+}
+
+void LeftBuildHashJoinOperator::push(vector<Row>& batch) {
+    for (auto& rightRow : batch) {
+        const vector<size_t>* found = nullptr;
+        if (rightColumn < rightRow.values.size() && !rightRow.values[rightColumn].isNull) {
+            auto it = table.find(joinKey(rightRow.values[rightColumn], mixedKeyClasses));
+            if (it != table.end()) found = &it->second;
+        }
+        if (!found && joinType != "RIGHT") continue;
+
+        size_t rightIdx = rightRows.size();
+        if (found) {
+            for (size_t leftIdx : *found) matches.emplace_back(leftIdx, rightIdx);
+        }
+        if (joinType == "RIGHT") rightMatched.push_back(found != nullptr);
+        rightRows.push_back(move(rightRow));
+    }
+}
+
+void LeftBuildHashJoinOperator::finish() {
+    // Counting sort of the matches by left row; stable, so each left row's
+    // matches stay in right-row order
+    vector<size_t> start(leftRows.size() + 1, 0);
+    for (const auto& match : matches) ++start[match.first + 1];
+    for (size_t i = 1; i < start.size(); ++i) start[i] += start[i - 1];
+    vector<size_t> byLeft(matches.size());
+    vector<size_t> fill(start.begin(), start.end() - 1);
+    for (const auto& match : matches) byLeft[fill[match.first]++] = match.second;
+    matches.clear();
+    matches.shrink_to_fit();
+
+    vector<Row> out;
+    auto flush = [&]() {
+        if (out.size() >= MORSEL_SIZE) {
+            emit(out);
+            out.clear();
+        }
+    };
+    for (size_t leftIdx = 0; leftIdx < leftRows.size(); ++leftIdx) {
+        // The left row is copied for all but its last match
+        for (size_t m = start[leftIdx]; m < start[leftIdx + 1]; ++m) {
+            const Row& rightRow = rightRows[byLeft[m]];
+            Row merged;
+            merged.values.reserve(leftRows[leftIdx].values.size() + rightRow.values.size());
+            if (m + 1 == start[leftIdx + 1]) {
+                merged.values = move(leftRows[leftIdx].values);
+            } else {
+                merged.values = leftRows[leftIdx].values;
+            }
+            merged.values.insert(merged.values.end(), rightRow.values.begin(), rightRow.values.end());
+            out.push_back(move(merged));
+            flush();
+        }
+    }
+    if (joinType == "RIGHT") {
+        // Unmatched right rows with NULLs for every left column
+        for (size_t i = 0; i < rightRows.size(); ++i) {
+            if (rightMatched[i]) continue;
+            Row padded;
+            padded.values.reserve(leftTypes.size() + rightRows[i].values.size());
+            for (DataType t : leftTypes) padded.values.push_back(Value::createNull(t));
+            padded.values.insert(padded.values.end(), make_move_iterator(rightRows[i].values.begin()),
+                                 make_move_iterator(rightRows[i].values.end()));
+            out.push_back(move(padded));
+            flush();
+        }
+    }
+    emit(out);
+    Operator::finish();
+}
+
+AggregateOperator::AggregateOperator(const vector<size_t>& groupColumns, const vector<AggregateSpec>& aggregates)
+    : partials(ThreadPool::instance().getDegreeOfParallelism(), HashAggregator(groupColumns, aggregates)) {}
+
+void AggregateOperator::push(vector<Row>& batch) {
+    for (auto& row : batch) buffer.push_back(move(row));
+    if (buffer.size() >= partials.size() * MORSEL_SIZE) flush();
+}
+
+void AggregateOperator::flush() {
+    HashAggregator::addInParallel(partials, buffer);
+    buffer.clear();
+}
+
+void AggregateOperator::finish() {
+    flush();
+    vector<Row> result = HashAggregator::mergePartials(partials);
+    emit(result);
+    Operator::finish();
+}
+
+SortOperator::SortOperator(const vector<SortKeySpec>& specs, size_t memoryBudget, const string& tempDirectory)
+    : sorter(specs, memoryBudget, tempDirectory) {}
+
+void SortOperator::push(vector<Row>& batch) {
+    for (auto& row : batch) sorter.add(move(row));
+}
+
+void SortOperator::finish() {
+    vector<Row> out;
+    sorter.finish([&](Row&& row) {
+        out.push_back(move(row));
+        if (out.size() >= MORSEL_SIZE) {
+            emit(out);
+            out.clear();
+        }
+    });
+    emit(out);
+    Operator::finish();
+}
+
+TopNOperator::TopNOperator(const vector<SortKeySpec>& s, size_t count)
+    : specs(s), n(count), compactAt(count > SIZE_MAX / 2 ? SIZE_MAX : max(2 * count, MORSEL_SIZE)) {}
+
+void TopNOperator::push(vector<Row>& batch) {
+    for (auto& row : batch) {
+        buffer.push_back(move(row));
+        if (buffer.size() >= compactAt) SortKey::topRows(buffer, specs, n);
+    }
+}
+
+void TopNOperator::finish() {
+    SortKey::topRows(buffer, specs, n);
+    emit(buffer);
+    buffer.clear();
+    Operator::finish();
+}
+
+LimitOperator::LimitOperator(size_t o, size_t l) : offset(o), limit(l), skipped(0), emitted(0) {}
+
+void LimitOperator::push(vector<Row>& batch) {
+    vector<Row> out;
+    for (auto& row : batch) {
+        if (skipped < offset) {
+            ++skipped;
+            continue;
+        }
+        if (emitted == limit) break;
+        out.push_back(move(row));
+        ++emitted;
+    }
+    emit(out);
+}
+
+bool LimitOperator::done() const {
+    return emitted == limit || Operator::done();
+}
+
+void ProjectOperator::push(vector<Row>& batch) {
+    vector<Row> out(batch.size());
+    for (size_t r = 0; r < batch.size(); ++r) {
+        const Row& row = batch[r];
+        out[r].values.reserve(columns.size());
+        for (size_t idx : columns) {
+            if (idx < row.values.size()) {
+                out[r].values.push_back(row.values[idx]);
+            }
+        }
+    }
+    emit(out);
+}
+
+void CollectOperator::push(vector<Row>& batch) {
+    if (rows.empty()) {
+        rows = move(batch);
+        return;
+    }
+    rows.insert(rows.end(), make_move_iterator(batch.begin()), make_move_iterator(batch.end()));
+}
@@ -0,0 +1,185 @@
+// include/Operator.h
+#pragma once
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "Value.h"
+#include "Row.h"
+#include "Column.h"
+#include "Condition.h"
+#include "HashAggregator.h"
+#include "SortKey.h"
+#include "ExternalSorter.h"
+
+using namespace std;
+
+class Table;
+
+// Push-based SELECT pipeline. A source pushes batches of rows into the first
+// operator and each operator pushes its output batches to the next one, so
+// streaming stages (join probe, limit, projection) only ever hold one batch.
+// Pipeline breakers (aggregation, sort) consume their whole input and emit in
+// finish().
+class Operator {
+public:
+    Operator() : next(nullptr) {}
+    virtual ~Operator() {}
+
+    void setNext(Operator* op) { next = op; }
+
+    // Consumes one batch; rows may be moved out of it
+    virtual void push(vector<Row>& batch) = 0;
+
+    // End of input: breakers emit their results, then finish is forwarded
+    virtual void finish() {
+        if (next) next->finish();
+    }
+
+    // True once no further input can change the result (e.g. LIMIT reached),
+    // so the source may stop early
+    virtual bool done() const { return next ? next->done() : false; }
+
+protected:
+    Operator* next;
+
+    void emit(vector<Row>& batch) {
+        if (next && !batch.empty()) next->push(batch);
+    }
+};
+
+// Streams the rows of 'table' matching 'where', cut down to 'columns', into
+// 'consumer' and finishes it
+void scanTable(const Table& table, const Condition& where, const vector<size_t>& columns, Operator& consumer);
+
+// Equi-join with the build side held in a hash table; probe rows stream
+// through in order and each is followed by its matches in build-row order.
+// joinType is "INNER", "LEFT" or "RIGHT"; unmatched build rows of a RIGHT
+// join are emitted at the end of input. NULL keys never match.
+class HashJoinOperator : public Operator {
+public:
+    HashJoinOperator(vector<Row> buildRows, size_t probeColumn, size_t buildColumn,
+                     bool mixedKeyClasses, const string& joinType,
+                     const vector<Column>& probeColumns, const vector<Column>& buildColumns);
+
+    void push(vector<Row>& batch) override;
+    void finish() override;
+
+private:
+    vector<Row> buildRows;
+    size_t probeColumn;
+    string joinType;
+    bool mixedKeyClasses;
+    vector<DataType> probeTypes;  // For NULL padding of unmatched rows
+    vector<DataType> buildTypes;
+    unordered_map<Value, vector<size_t>, ValueHash, ValueEqual> table;
+    vector<bool> buildMatched;    // RIGHT join only
+};
+
+// The same join with the hash table on the probe side instead, for when the
+// rows flowing in so far (the left input) are the smaller input: they are
+// hashed up front and the joined table's rows stream through. Matches are
+// bucketed by left row and emitted at end of input, so the output order is
+// HashJoinOperator's. joinType is "INNER" or "RIGHT"; a LEFT join needs
+// every left row to probe.
+class LeftBuildHashJoinOperator : public Operator {
+public:
+    LeftBuildHashJoinOperator(vector<Row> leftRows, size_t leftColumn, size_t rightColumn,
+                              bool mixedKeyClasses, const string& joinType, const vector<Column>& leftColumns);
+
+    void push(vector<Row>& batch) override;
+    void finish() override;
+    bool done() const override { return false; }
+
+private:
+    vector<Row> leftRows;
+    size_t rightColumn;
+    string joinType;
+    bool mixedKeyClasses;
+    vector<DataType> leftTypes;   // For NULL padding of unmatched right rows
+    unordered_map<Value, vector<size_t>, ValueHash, ValueEqual> table;
+    vector<Row> rightRows;        // Matched right rows; all of them for RIGHT
+    vector<bool> rightMatched;    // RIGHT join only
+    vector<pair<size_t, size_t>> matches; // (left row, right row), in right-row order
+};
+
+// GROUP BY / aggregates over streamed input. Batches are buffered until every
+// thread has a morsel, then folded into per-thread partial tables in parallel.
+class AggregateOperator : public Operator {
+public:
+    AggregateOperator(const vector<size_t>& groupColumns, const vector<AggregateSpec>& aggregates);
+
+    void push(vector<Row>& batch) override;
+    void finish() override;
+    bool done() const override { return false; }
+
+private:
+    vector<HashAggregator> partials;
+    vector<Row> buffer;
+
+    void flush();
+};
+
+// ORDER BY through an ExternalSorter, so large inputs spill sorted runs
+class SortOperator : public Operator {
+public:
+    SortOperator(const vector<SortKeySpec>& specs, size_t memoryBudget, const string& tempDirectory);
+
+    void push(vector<Row>& batch) override;
+    void finish() override;
+    bool done() const override { return false; }
+
+private:
+    ExternalSorter sorter;
+};
+
+// ORDER BY ... LIMIT: keeps only the first n rows of the sorted order. The
+// buffer is cut back to the best n whenever it grows past twice that.
+class TopNOperator : public Operator {
+public:
+    TopNOperator(const vector<SortKeySpec>& specs, size_t n);
+
+    void push(vector<Row>& batch) override;
+    void finish() override;
+    bool done() const override { return false; }
+
+private:
+    vector<SortKeySpec> specs;
+    size_t n;
+    size_t compactAt;
+    vector<Row> buffer;
+};
+
+// LIMIT n OFFSET m over the stream
+class LimitOperator : public Operator {
+public:
+    LimitOperator(size_t offset, size_t limit);
+
+    void push(vector<Row>& batch) override;
+    bool done() const override;
+
+private:
+    size_t offset;
+    size_t limit;
+    size_t skipped;
+    size_t emitted;
+};
+
+// Rebuilds each row from the listed input columns; indices past the end of a
+// row are skipped
+class ProjectOperator : public Operator {
+public:
+    explicit ProjectOperator(const vector<size_t>& columns) : columns(columns) {}
+
+    void push(vector<Row>& batch) override;
+
+private:
+    vector<size_t> columns;
+};
+
+// Pipeline sink: collects the final rows
+class CollectOperator : public Operator {
+public:
+    vector<Row> rows;
+
+    void push(vector<Row>& batch) override;
+};
@@ -6,9 +6,13 @@
 #include "DeleteQuery.h"
 #include "CreateTableQuery.h"
 #include "DropTableQuery.h"
+#include "CreateIndexQuery.h"
+#include "DropIndexQuery.h"
+#include "CopyQuery.h"
 #include <sstream>
 #include <algorithm>
 #include <cctype>
+#include <charconv>
 
 using namespace std;
 
@@ -118,6 +122,44 @@ bool hasProperSpacing(const string& upperQuery, const string& keyword, size_t ke
     return isspace(nextChar) || nextChar == '(' || nextChar == ';';
 }
 
+// Position of the last occurrence of keyword as a separate word outside
+// quoted literals ('...' or "..."), or npos
+size_t findLastKeyword(const string& upperQuery, const string& keyword) {
+    vector<bool> quoted(upperQuery.length(), false);
+    char quote = 0;
+    for (size_t i = 0; i < upperQuery.length(); ++i) {
+        char ch = upperQuery[i];
+        if (quote) {
+            quoted[i] = true;
+            if (ch == quote) quote = 0; // A doubled quote reopens at once
+        } else if (ch == '\'' || ch == '"') {
+            quote = ch;
+            quoted[i] = true;
+        }
+    }
+
+    size_t pos = upperQuery.rfind(keyword);
+    while (pos != string::npos) {
+        size_t endPos = pos + keyword.length();
+        bool startsWord = pos > 0 && isspace(static_cast<unsigned char>(upperQuery[pos - 1]));
+        bool endsWord = endPos >= upperQuery.length() || isspace(static_cast<unsigned char>(upperQuery[endPos]));
+        if (startsWord && endsWord && !quoted[pos]) return pos;
+        if (pos == 0) break;
+        pos = upperQuery.rfind(keyword, pos - 1);
+    }
+    return string::npos;
+}
+
+// Parse a non-negative row count (LIMIT/OFFSET)
+bool parseRowCount(const string& text, size_t& out) {
+    if (text.empty()) return false;
+    for (char ch : text) {
+        if (!isdigit(static_cast<unsigned char>(ch))) return false;
+    }
+    auto res = from_chars(text.data(), text.data() + text.size(), out);
+    return res.ec == errc() && res.ptr == text.data() + text.size();
+}
+
 // Validate data type string is valid
 bool isValidDataType(const string& typeStr) {
     string upper = toUpper(typeStr);
@@ -301,10 +343,11 @@ Query* Parser::parse(const string& sqlText) {
         size_t joinPos = upperQuery.find("JOIN");
         size_t groupByPos = upperQuery.find("GROUP BY");
         size_t orderByPos = upperQuery.find("ORDER BY");
+        size_t limitPos = findLastKeyword(upperQuery, "LIMIT"); // Always the last clause
         
         // Determine the end of the FROM clause
         size_t fromEnd = string::npos;
-        vector<size_t> positions = {wherePos, joinPos, groupByPos, orderByPos};
+        vector<size_t> positions = {wherePos, joinPos, groupByPos, orderByPos, limitPos};
         for (size_t pos : positions) {
             if (pos != string::npos && (fromEnd == string::npos || pos < fromEnd)) {
                 fromEnd = pos;
@@ -393,7 +436,7 @@ Query* Parser::parse(const string& sqlText) {
                 // Find next clause to determine end of ON
                 size_t onEnd = string::npos;
                 size_t nextJoin = upperQuery.find("JOIN", onPos);
-                vector<size_t> nextPositions = {wherePos, nextJoin, groupByPos, orderByPos};
+                vector<size_t> nextPositions = {wherePos, nextJoin, groupByPos, orderByPos, limitPos};
                 for (size_t pos : nextPositions) {
                     if (pos != string::npos && pos > onPos && (onEnd == string::npos || pos < onEnd)) {
                         onEnd = pos;
@@ -438,7 +481,7 @@ Query* Parser::parse(const string& sqlText) {
         // Parse WHERE clause
         if (wherePos != string::npos) {
             size_t whereEnd = string::npos;
-            vector<size_t> nextPositions = {groupByPos, orderByPos};
+            vector<size_t> nextPositions = {groupByPos, orderByPos, limitPos};
             for (size_t pos : nextPositions) {
                 if (pos != string::npos && (whereEnd == string::npos || pos < whereEnd)) {
                     whereEnd = pos;
@@ -452,14 +495,16 @@ Query* Parser::parse(const string& sqlText) {
 
         // Parse GROUP BY
         if (groupByPos != string::npos) {
-            size_t groupByEnd = orderByPos != string::npos ? orderByPos : sqlText.length();
+            size_t groupByEnd = orderByPos != string::npos ? orderByPos :
+                                (limitPos != string::npos ? limitPos : sqlText.length());
             string groupByPart = trim(sqlText.substr(groupByPos + 8, groupByEnd - groupByPos - 8));
             q->groupBy = split(groupByPart, ',');
         }
 
         // Parse ORDER BY
         if (orderByPos != string::npos) {
-            string orderByPart = trim(sqlText.substr(orderByPos + 8));
+            size_t orderByEnd = limitPos != string::npos && limitPos > orderByPos ? limitPos : sqlText.length();
+            string orderByPart = trim(sqlText.substr(orderByPos + 8, orderByEnd - orderByPos - 8));
             auto orderItems = split(orderByPart, ',');
             for (const auto& item : orderItems) {
                 SortRule rule;
@@ -480,6 +525,24 @@ Query* Parser::parse(const string& sqlText) {
             }
         }
 
+        // Parse LIMIT n [OFFSET m]
+        if (limitPos != string::npos) {
+            string limitPart = trim(sqlText.substr(limitPos + 5));
+            string countPart = limitPart;
+            string offsetPart;
+            size_t offsetPos = findLastKeyword(" " + toUpper(limitPart), "OFFSET");
+            if (offsetPos != string::npos) {
+                countPart = trim(limitPart.substr(0, offsetPos - 1));
+                offsetPart = trim(limitPart.substr(offsetPos + 5));
+            }
+            if (!parseRowCount(countPart, q->limit) ||
+                (offsetPos != string::npos && !parseRowCount(offsetPart, q->offset))) {
+                delete q;
+                return nullptr;
+            }
+            q->hasLimit = true;
+        }
+
         return q;
     } else if (upperQuery.find("INSERT") == 0) {
         // Validate INSERT has proper spacing
@@ -604,6 +667,83 @@ Query* Parser::parse(const string& sqlText) {
             q->tableAlias = tablePart; // No separate alias
         }
 
+        return q;
+    } else if (upperQuery.find("CREATE") == 0 && trim(upperQuery.substr(6)).find("INDEX") == 0) {
+        // CREATE INDEX index_name ON table_name(column_name)
+        if (!hasProperSpacing(upperQuery, "CREATE", 0)) {
+            return nullptr;
+        }
+
+        CreateIndexQuery* q = new CreateIndexQuery();
+        size_t indexPos = upperQuery.find("INDEX");
+        size_t onPos = upperQuery.find(" ON ", indexPos);
+        size_t openParen = sqlText.find('(', indexPos);
+        size_t closeParen = sqlText.rfind(')');
+        if (onPos == string::npos || openParen == string::npos || closeParen == string::npos ||
+            openParen < onPos || closeParen < openParen) {
+            delete q;
+            return nullptr;
+        }
+
+        q->indexName = trim(sqlText.substr(indexPos + 5, onPos - indexPos - 5));
+        q->tableName = trim(sqlText.substr(onPos + 4, openParen - onPos - 4));
+        q->columnName = trim(sqlText.substr(openParen + 1, closeParen - openParen - 1));
+
+        // Every index is a B+tree; no USING clause or other text may follow
+        if (!isValidIdentifier(q->indexName) || !isValidIdentifier(q->tableName) ||
+            !isValidIdentifier(q->columnName) || !trim(sqlText.substr(closeParen + 1)).empty()) {
+            delete q;
+            return nullptr;
+        }
+
+        return q;
+    } else if (upperQuery.find("DROP") == 0 && trim(upperQuery.substr(4)).find("INDEX") == 0) {
+        // DROP INDEX index_name [ON table_name]
+        if (!hasProperSpacing(upperQuery, "DROP", 0)) {
+            return nullptr;
+        }
+
+        DropIndexQuery* q = new DropIndexQuery();
+        size_t indexPos = upperQuery.find("INDEX");
+        size_t onPos = upperQuery.find(" ON ", indexPos);
+        if (onPos != string::npos) {
+            q->indexName = trim(sqlText.substr(indexPos + 5, onPos - indexPos - 5));
+            q->tableName = trim(sqlText.substr(onPos + 4));
+        } else {
+            q->indexName = trim(sqlText.substr(indexPos + 5));
+        }
+
+        if (!isValidIdentifier(q->indexName) || (onPos != string::npos && !isValidIdentifier(q->tableName))) {
+            delete q;
+            return nullptr;
+        }
+
+        return q;
+    } else if (upperQuery.find("CREATE") == 0 && trim(upperQuery.substr(6)).find("EXTERNAL") == 0) {
+        // CREATE EXTERNAL TABLE table_name FROM 'file.csv'
+        if (!hasProperSpacing(upperQuery, "CREATE", 0)) {
+            return nullptr;
+        }
+
+        CreateTableQuery* q = new CreateTableQuery();
+        size_t tablePos = upperQuery.find("TABLE");
+        size_t fromPos = upperQuery.find(" FROM ", tablePos);
+        if (tablePos == string::npos || fromPos == string::npos ||
+            !hasProperSpacing(upperQuery, "TABLE", tablePos) ||
+            trim(upperQuery.substr(6, tablePos - 6)) != "EXTERNAL") {
+            delete q;
+            return nullptr;
+        }
+
+        q->tableName = trim(sqlText.substr(tablePos + 5, fromPos - tablePos - 5));
+        q->externalPath = stripQuotes(sqlText.substr(fromPos + 6));
+        q->storageMode = StorageMode::EXTERNAL;
+
+        if (!isValidIdentifier(q->tableName) || q->externalPath.empty()) {
+            delete q;
+            return nullptr;
+        }
+
         return q;
     } else if (upperQuery.find("CREATE") == 0 && upperQuery.find("TABLE") != string::npos) {
         // Validate CREATE has proper spacing
@@ -703,6 +843,18 @@ Query* Parser::parse(const string& sqlText) {
             return nullptr;
         }
 
+        // Optional storage clause after the column list: USING COLUMNAR | USING ROW.
+        // Anything else is an error, so a misspelt mode does not fall back to ROW.
+        string storagePart = toUpper(trim(sqlText.substr(closeParen + 1)));
+        if (storagePart == "USING COLUMNAR") {
+            q->storageMode = StorageMode::COLUMNAR;
+        } else if (storagePart == "USING ROW") {
+            q->storageMode = StorageMode::ROW;
+        } else if (!storagePart.empty()) {
+            delete q;
+            return nullptr;
+        }
+
         return q;
     } else if (upperQuery.find("DROP") == 0 && upperQuery.find("TABLE") != string::npos) {
         // Validate DROP has proper spacing
@@ -753,6 +905,28 @@ Query* Parser::parse(const string& sqlText) {
             return nullptr;
         }
 
+        return q;
+    } else if (upperQuery.find("COPY") == 0) {
+        // COPY table_name FROM 'file.csv'
+        if (!hasProperSpacing(upperQuery, "COPY", 0)) {
+            return nullptr;
+        }
+
+        CopyQuery* q = new CopyQuery();
+        size_t fromPos = upperQuery.find(" FROM ");
+        if (fromPos == string::npos) {
+            delete q;
+            return nullptr;
+        }
+
+        q->tableName = trim(sqlText.substr(4, fromPos - 4));
+        q->filePath = stripQuotes(sqlText.substr(fromPos + 6));
+
+        if (!isValidIdentifier(q->tableName) || q->filePath.empty()) {
+            delete q;
+            return nullptr;
+        }
+
         return q;
     }
 
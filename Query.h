@@ -8,6 +8,9 @@ enum class QueryType {
     DELETE,
     CREATE_TABLE,
     DROP_TABLE,
+    CREATE_INDEX,
+    DROP_INDEX,
+    COPY,
     UNKNOWN
 };
 
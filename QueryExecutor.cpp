@@ -6,7 +6,13 @@
 #include "DeleteQuery.h"
 #include "CreateTableQuery.h"
 #include "DropTableQuery.h"
+#include "CreateIndexQuery.h"
+#include "DropIndexQuery.h"
+#include "CopyQuery.h"
+#include "HashAggregator.h"
+#include "Operator.h"
 #include <algorithm>
+#include <memory>
 
 using namespace std;
 
@@ -64,6 +70,15 @@ void QueryExecutor::execute(Query* q, Database& db) {
     case QueryType::DROP_TABLE:
         executeDropTable(static_cast<DropTableQuery*>(q), db);
         break;
+    case QueryType::CREATE_INDEX:
+        executeCreateIndex(static_cast<CreateIndexQuery*>(q), db);
+        break;
+    case QueryType::DROP_INDEX:
+        executeDropIndex(static_cast<DropIndexQuery*>(q), db);
+        break;
+    case QueryType::COPY:
+        executeCopy(static_cast<CopyQuery*>(q), db);
+        break;
     default:
         error("Unknown query type");
     }
@@ -92,12 +107,24 @@ void QueryExecutor::executeSelect(SelectQuery* q, Database& db) {
         }
     }
 
-    vector<Row> selected = table->selectRows(q->where);
+    // The query is planned first and then run as a pipeline of operators:
+    // scan -> joins -> aggregate -> sort -> limit -> project. Only the join
+    // build sides, aggregation and sorting hold more than one batch of rows.
+    // Column indices below are planned against the full joined row and
+    // remapped once the columns the query actually reads are known.
+    struct JoinStep {
+        Table* table;
+        size_t leftColumn;    // Probe key, in the joined row
+        size_t rightColumn;   // Build key, in the joined table
+        size_t firstColumn;   // Where the joined table's columns start in the joined row
+        bool mixedKeyClasses;
+        string joinType;
+    };
+    vector<JoinStep> joinSteps;
 
-    // Handle JOINs
+    // Handle JOINs: each joined table is the build side of a hash join probed
+    // by the rows flowing out of the previous stage
     vector<Column> allColumns = table->getColumns();
-    vector<Row> joinedRows = selected;
-    
     for (const auto& join : q->joins) {
         Table* joinTable = db.getTable(join.tableName);
         if (!joinTable) {
@@ -106,7 +133,6 @@ void QueryExecutor::executeSelect(SelectQuery* q, Database& db) {
         }
         
         const auto& joinTableColumns = joinTable->getColumns();
-        const auto& joinTableRows = joinTable->getRows();
         
         // Find column indices
         size_t leftColIdx = 0;
@@ -134,131 +160,10 @@ void QueryExecutor::executeSelect(SelectQuery* q, Database& db) {
             return;
         }
         
-        // Perform join
-        vector<Row> newJoinedRows;
+        bool mixedKeyClasses = Value::isNumericType(allColumns[leftColIdx].type) !=
+                               Value::isNumericType(joinTableColumns[rightColIdx].type);
+        joinSteps.push_back({joinTable, leftColIdx, rightColIdx, allColumns.size(), mixedKeyClasses, join.joinType});
         
-        // Process based on join type
-        if (join.joinType == "INNER") {
-            // INNER JOIN: only include matching rows
-            for (const auto& leftRow : joinedRows) {
-                // Validate leftColIdx is in range
-                if (leftColIdx >= leftRow.values.size()) continue;
-                
-                for (const auto& rightRow : joinTableRows) {
-                    // Validate rightColIdx is in range
-                    if (rightColIdx >= rightRow.values.size()) continue;
-                    
-                    // For JOIN condition: handle NULL values properly
-                    // NULL values never match anything (including other NULLs) in SQL JOIN semantics
-                    const Value& leftVal = leftRow.values[leftColIdx];
-                    const Value& rightVal = rightRow.values[rightColIdx];
-                    
-                    // Only match if both are non-NULL and equal
-                    if (!leftVal.isNull && !rightVal.isNull && leftVal.data == rightVal.data) {
-                        // Merge rows
-                        Row mergedRow;
-                        mergedRow.values = leftRow.values;
-                        for (const auto& val : rightRow.values) {
-                            mergedRow.values.push_back(val);
-                        }
-                        newJoinedRows.push_back(mergedRow);
-                    }
-                }
-            }
-        } else if (join.joinType == "LEFT") {
-            // LEFT JOIN: include all left rows, matching right rows where possible
-            for (const auto& leftRow : joinedRows) {
-                bool leftHasMatch = false;
-                
-                // Validate leftColIdx is in range
-                if (leftColIdx < leftRow.values.size()) {
-                    const Value& leftVal = leftRow.values[leftColIdx];
-                    
-                    for (const auto& rightRow : joinTableRows) {
-                        // Validate rightColIdx is in range
-                        if (rightColIdx >= rightRow.values.size()) continue;
-                        
-                        const Value& rightVal = rightRow.values[rightColIdx];
-                        
-                        // Only match if both are non-NULL and equal
-                        if (!leftVal.isNull && !rightVal.isNull && leftVal.data == rightVal.data) {
-                            // Merge rows
-                            Row mergedRow;
-                            mergedRow.values = leftRow.values;
-                            for (const auto& val : rightRow.values) {
-                                mergedRow.values.push_back(val);
-                            }
-                            newJoinedRows.push_back(mergedRow);
-                            leftHasMatch = true;
-                        }
-                    }
-                }
-                
-                // For LEFT JOIN, if no match found, include left row with NULL right values
-                if (!leftHasMatch) {
-                    Row mergedRow;
-                    mergedRow.values = leftRow.values;
-                    // Add NULL values for all joined table columns
-                    for (const auto& col : joinTableColumns) {
-                        mergedRow.values.push_back(Value::createNull(col.type));
-                    }
-                    newJoinedRows.push_back(mergedRow);
-                }
-            }
-        } else if (join.joinType == "RIGHT") {
-            // RIGHT JOIN: include all right rows, matching left rows where possible
-            vector<bool> rightRowMatched(joinTableRows.size(), false);
-            
-            // Store the number of columns before adding the join table columns
-            size_t leftColumnsCount = allColumns.size();
-            
-            // First pass: find and add all matching rows
-            for (const auto& leftRow : joinedRows) {
-                // Validate leftColIdx is in range
-                if (leftColIdx >= leftRow.values.size()) continue;
-                
-                const Value& leftVal = leftRow.values[leftColIdx];
-                
-                for (size_t rightIdx = 0; rightIdx < joinTableRows.size(); ++rightIdx) {
-                    const auto& rightRow = joinTableRows[rightIdx];
-                    
-                    // Validate rightColIdx is in range
-                    if (rightColIdx >= rightRow.values.size()) continue;
-                    
-                    const Value& rightVal = rightRow.values[rightColIdx];
-                    
-                    // Only match if both are non-NULL and equal
-                    if (!leftVal.isNull && !rightVal.isNull && leftVal.data == rightVal.data) {
-                        // Merge rows
-                        Row mergedRow;
-                        mergedRow.values = leftRow.values;
-                        for (const auto& val : rightRow.values) {
-                            mergedRow.values.push_back(val);
-                        }
-                        newJoinedRows.push_back(mergedRow);
-                        rightRowMatched[rightIdx] = true;
-                    }
-                }
-            }
-            
-            // Second pass: add all unmatched right rows with NULL left values
-            for (size_t rightIdx = 0; rightIdx < joinTableRows.size(); ++rightIdx) {
-                if (!rightRowMatched[rightIdx]) {
-                    Row mergedRow;
-                    // Add NULL values for all left columns (before this join)
-                    for (size_t i = 0; i < leftColumnsCount; ++i) {
-                        mergedRow.values.push_back(Value::createNull(allColumns[i].type));
-                    }
-                    // Add actual values from the unmatched right row
-                    for (const auto& val : joinTableRows[rightIdx].values) {
-                        mergedRow.values.push_back(val);
-                    }
-                    newJoinedRows.push_back(mergedRow);
-                }
-            }
-        }
-        
-        joinedRows = newJoinedRows;
         // Add joined table columns to column list
         for (const auto& col : joinTableColumns) {
             allColumns.push_back(col);
@@ -266,10 +171,15 @@ void QueryExecutor::executeSelect(SelectQuery* q, Database& db) {
     }
 
     // Handle GROUP BY
-    vector<Row> groupedRows = joinedRows;
+    vector<Column> joinedColumns = allColumns;
     vector<Column> groupedColumns = allColumns;
+    bool aggregating = !q->groupBy.empty() || !q->aggregates.empty();
+    vector<size_t> groupByIndices;
+    vector<AggregateSpec> aggregateSpecs;
+    vector<size_t> groupRowColumns;
+    bool reorderGroupRows = false;
     
-    if (!q->groupBy.empty() || !q->aggregates.empty()) {
+    if (aggregating) {
         // Validate GROUP BY columns exist
         for (const auto& colName : q->groupBy) {
             bool found = false;
@@ -303,7 +213,6 @@ void QueryExecutor::executeSelect(SelectQuery* q, Database& db) {
         }
         
         // Find group by column indices
-        vector<size_t> groupByIndices;
         for (const auto& colName : q->groupBy) {
             for (size_t i = 0; i < allColumns.size(); ++i) {
                 if (allColumns[i].name == colName) {
@@ -313,27 +222,26 @@ void QueryExecutor::executeSelect(SelectQuery* q, Database& db) {
             }
         }
         
-        // Group rows by the specified columns
-        map<string, vector<Row>> groups;
-        for (const auto& row : joinedRows) {
-            string groupKey;
-            for (size_t idx : groupByIndices) {
-                if (idx < row.values.size()) {
-                    groupKey += row.values[idx].data + "|";
-                }
+        // Resolve aggregate functions and their input columns once
+        for (const auto& agg : q->aggregates) {
+            AggregateSpec spec;
+            spec.column = 0;
+            if (!HashAggregator::parseFunction(agg.function, agg.column, spec.kind)) {
+                error("Unsupported aggregate function: " + agg.function);
+                return;
             }
-            
-            // If no GROUP BY columns but has aggregates, use single group
-            if (groupKey.empty() && !q->aggregates.empty()) {
-                groupKey = "ALL";
+            if (agg.column != "*") {
+                for (size_t i = 0; i < allColumns.size(); ++i) {
+                    if (allColumns[i].name == agg.column) {
+                        spec.column = i;
+                        break;
+                    }
+                }
             }
-            
-            groups[groupKey].push_back(row);
+            aggregateSpecs.push_back(spec);
         }
-        groupedRows.clear();
         
-        // Calculate aggregates for each group
-        groupedRows.clear();
+        // Aggregator rows hold the GROUP BY values followed by the aggregates
         groupedColumns.clear();
         
         // If we have aggregates but explicit columns selected, use SELECT order
@@ -357,6 +265,24 @@ void QueryExecutor::executeSelect(SelectQuery* q, Database& db) {
                 aggCol.type = DataType::FLOAT;
                 groupedColumns.push_back(aggCol);
             }
+            
+            // Reorder the aggregator rows to match: each non-aggregate column
+            // takes its GROUP BY value (none if it is not grouped), then the
+            // aggregate values follow
+            for (size_t c = 0; c < groupedColumns.size() - q->aggregates.size(); ++c) {
+                size_t source = SIZE_MAX;
+                for (size_t k = 0; k < groupByIndices.size(); ++k) {
+                    if (allColumns[groupByIndices[k]].name == groupedColumns[c].name) {
+                        source = k;
+                        break;
+                    }
+                }
+                if (source != SIZE_MAX) groupRowColumns.push_back(source);
+            }
+            for (size_t i = 0; i < q->aggregates.size(); ++i) {
+                groupRowColumns.push_back(groupByIndices.size() + i);
+            }
+            reorderGroupRows = true;
         } else {
             // No explicit SELECT columns, use default order: GROUP BY columns first
             for (const auto& colName : q->groupBy) {
@@ -377,129 +303,12 @@ void QueryExecutor::executeSelect(SelectQuery* q, Database& db) {
             }
         }
         
-        // Process each group
-        for (const auto& pair : groups) {
-            const auto& groupRows = pair.second;
-            if (groupRows.empty()) continue;
-            
-            Row resultRow;
-            
-            // Build row in the same order as groupedColumns
-            // If SELECT specified columns, follow that order
-            if (!q->columns.empty() && q->columns[0] != "*") {
-                // Process in SELECT order
-                for (const auto& col : groupedColumns) {
-                    bool isAggregate = false;
-                    
-                    // Check if this column is an aggregate
-                    for (const auto& agg : q->aggregates) {
-                        if (col.name == agg.alias) {
-                            isAggregate = true;
-                            // Calculate aggregate (will be added below)
-                            break;
-                        }
-                    }
-                    
-                    if (!isAggregate) {
-                        // It's a GROUP BY column, add its value
-                        for (size_t idx : groupByIndices) {
-                            if (allColumns[idx].name == col.name && idx < groupRows[0].values.size()) {
-                                resultRow.values.push_back(groupRows[0].values[idx]);
-                                break;
-                            }
-                        }
-                    }
-                }
-            } else {
-                // Default order: GROUP BY columns first
-                for (size_t idx : groupByIndices) {
-                    if (idx < groupRows[0].values.size()) {
-                        resultRow.values.push_back(groupRows[0].values[idx]);
-                    }
-                }
-            }
-            
-            // Calculate and add aggregate values in order
-            for (const auto& agg : q->aggregates) {
-                // Find column index for this aggregate (unless it's COUNT(*))
-                size_t colIdx = 0;
-                bool found = false;
-                
-                if (agg.column != "*") {
-                    for (size_t i = 0; i < allColumns.size(); ++i) {
-                        if (allColumns[i].name == agg.column) {
-                            colIdx = i;
-                            found = true;
-                            break;
-                        }
-                    }
-                    
-                    if (!found) {
-                        error("Aggregate column not found: " + agg.column);
-                        return;
-                    }
-                }
-                
-                // Calculate aggregate
-                double result = 0.0;
-                int count = 0;
-                double sum = 0.0;
-                double minVal = 0.0;
-                double maxVal = 0.0;
-                bool first = true;
-                
-                // COUNT(*) just counts all rows
-                if (agg.function == "COUNT" && agg.column == "*") {
-                    result = static_cast<double>(groupRows.size());
-                } else {
-                    for (const auto& row : groupRows) {
-                        if (colIdx < row.values.size()) {
-                            try {
-                                double val = stod(row.values[colIdx].data);
-                                
-                                if (agg.function == "SUM" || agg.function == "AVG") {
-                                    sum += val;
-                                }
-                                if (agg.function == "MIN") {
-                                    if (first || val < minVal) minVal = val;
-                                }
-                                if (agg.function == "MAX") {
-                                    if (first || val > maxVal) maxVal = val;
-                                }
-                                
-                                count++;
-                                first = false;
-                            } catch (...) {
-                                // Skip non-numeric values
-                            }
-                        }
-                    }
-                    
-                    // Set result based on function type
-                    if (agg.function == "COUNT") {
-                        result = static_cast<double>(count);
-                    } else if (agg.function == "SUM") {
-                        result = sum;
-                    } else if (agg.function == "AVG") {
-                        result = count > 0 ? sum / count : 0.0;
-                    } else if (agg.function == "MIN") {
-                        result = minVal;
-                    } else if (agg.function == "MAX") {
-                        result = maxVal;
-                    }
-                }
-                
-                resultRow.values.emplace_back(DataType::FLOAT, to_string(result));
-            }
-            
-            groupedRows.push_back(resultRow);
-        }
-        
         // Update allColumns to reflect grouped columns
         allColumns = groupedColumns;
     }
 
     // Handle ORDER BY
+    vector<SortKeySpec> sortSpecs;
     if (!q->orderBy.empty()) {
         // Validate ORDER BY columns exist
         for (const auto& rule : q->orderBy) {
@@ -516,36 +325,20 @@ void QueryExecutor::executeSelect(SelectQuery* q, Database& db) {
             }
         }
         
-        vector<size_t> orderByIndices;
+        // Each row's sort columns are encoded once and sorted on the encoded keys
         for (const auto& rule : q->orderBy) {
             for (size_t i = 0; i < allColumns.size(); ++i) {
                 if (allColumns[i].name == rule.column) {
-                    orderByIndices.push_back(i);
+                    sortSpecs.push_back({i, rule.ascending});
                     break;
                 }
             }
         }
-        
-        sort(groupedRows.begin(), groupedRows.end(), [&](const Row& a, const Row& b) {
-            for (size_t i = 0; i < q->orderBy.size() && i < orderByIndices.size(); ++i) {
-                size_t idx = orderByIndices[i];
-                if (idx >= a.values.size() || idx >= b.values.size()) continue;
-                
-                if (a.values[idx] == b.values[idx]) continue;
-                
-                if (q->orderBy[i].ascending) {
-                    return a.values[idx] < b.values[idx];
-                } else {
-                    return a.values[idx] > b.values[idx];
-                }
-            }
-            return false;
-        });
     }
 
     // Handle column projection
     vector<Column> resultColumns;
-    vector<Row> projectedRows;
+    vector<size_t> selectedIndices;
     
     // Check if selecting all columns (*)
     bool selectAll = (q->columns.size() == 1 && q->columns[0] == "*" && q->aggregates.empty());
@@ -553,11 +346,9 @@ void QueryExecutor::executeSelect(SelectQuery* q, Database& db) {
     if (selectAll) {
         // Return all columns
         resultColumns = allColumns;
-        projectedRows = groupedRows;
     } else if (!q->groupBy.empty() || !q->aggregates.empty()) {
         // When using GROUP BY or aggregates, columns are already properly set up
         resultColumns = allColumns;
-        projectedRows = groupedRows;
     } else {
         // Project only requested columns (no GROUP BY/aggregates)
         // Build column index mapping with table prefix support
@@ -597,7 +388,6 @@ void QueryExecutor::executeSelect(SelectQuery* q, Database& db) {
         }
         
         // Get indices of requested columns, expanding alias.* patterns
-        vector<size_t> selectedIndices;
         for (const auto& colName : q->columns) {
             // Check if it's a wildcard pattern (alias.* or table.*)
             size_t dotPos = colName.find('.');
@@ -654,18 +444,134 @@ void QueryExecutor::executeSelect(SelectQuery* q, Database& db) {
                 }
             }
         }
+    }
+
+    // Projection pushdown: only joined-row columns some stage reads are
+    // scanned and carried through the joins; rows are compacted to those
+    size_t joinedWidth = joinedColumns.size();
+    vector<bool> needed(joinedWidth, false);
+    for (const auto& step : joinSteps) {
+        needed[step.leftColumn] = true;
+        needed[step.firstColumn + step.rightColumn] = true;
+    }
+    if (aggregating) {
+        for (size_t idx : groupByIndices) needed[idx] = true;
+        for (const auto& spec : aggregateSpecs) {
+            if (spec.kind != AggregateKind::COUNT_STAR) needed[spec.column] = true;
+        }
+    } else if (selectAll) {
+        needed.assign(joinedWidth, true);
+    } else {
+        for (size_t idx : selectedIndices) needed[idx] = true;
+        for (const auto& spec : sortSpecs) needed[spec.column] = true;
+    }
+    
+    // compactIndex[i] is column i's position in the compacted row
+    vector<size_t> compactIndex(joinedWidth, SIZE_MAX);
+    size_t compactWidth = 0;
+    for (size_t i = 0; i < joinedWidth; ++i) {
+        if (needed[i]) compactIndex[i] = compactWidth++;
+    }
+    auto neededColumnsOf = [&](size_t first, size_t count) {
+        vector<size_t> local;
+        for (size_t i = 0; i < count; ++i) {
+            if (needed[first + i]) local.push_back(i);
+        }
+        return local;
+    };
+    
+    // The first INNER or RIGHT join hashes the base table instead when it is
+    // the smaller input; the joined table is then the scan source. Its output
+    // waits for the end of input (to keep base-row order), so a LIMIT that
+    // could stop a streaming scan early keeps the usual plan. External tables
+    // are left out: counting their rows reads the whole file.
+    bool stopsEarly = q->hasLimit && sortSpecs.empty() && !aggregating;
+    bool buildOnBase = !joinSteps.empty() && !stopsEarly &&
+                       (joinSteps[0].joinType == "INNER" || joinSteps[0].joinType == "RIGHT") &&
+                       !table->isExternal() && !joinSteps[0].table->isExternal() &&
+                       table->getRowCount() < joinSteps[0].table->getRowCount();
+
+    vector<unique_ptr<Operator>> pipeline;
+    size_t baseColumnCount = table->getColumns().size();
+    vector<size_t> scanColumns = neededColumnsOf(0, baseColumnCount);
+    auto collectRows = [](const Table& source, const Condition& where, const vector<size_t>& columns) {
+        vector<Row> rows;
+        source.scanRows(where, columns, [&](vector<Row>& batch) {
+            rows.insert(rows.end(), make_move_iterator(batch.begin()), make_move_iterator(batch.end()));
+            return true;
+        });
+        return rows;
+    };
+    for (size_t s = 0; s < joinSteps.size(); ++s) {
+        const JoinStep& step = joinSteps[s];
+        size_t joinColumnCount = step.table->getColumns().size();
+        vector<size_t> buildColumns = neededColumnsOf(step.firstColumn, joinColumnCount);
         
-        // Project rows to only include selected columns
-        for (const auto& row : groupedRows) {
-            Row projectedRow;
-            for (size_t idx : selectedIndices) {
-                if (idx < row.values.size()) {
-                    projectedRow.values.push_back(row.values[idx]);
-                }
-            }
-            projectedRows.push_back(projectedRow);
+        // Compacted column lists on each side, for NULL padding
+        vector<Column> probeColumns, buildSide;
+        for (size_t i = 0; i < step.firstColumn; ++i) {
+            if (needed[i]) probeColumns.push_back(joinedColumns[i]);
         }
+        for (size_t i : buildColumns) buildSide.push_back(joinedColumns[step.firstColumn + i]);
+        size_t buildKey = compactIndex[step.firstColumn + step.rightColumn] - probeColumns.size();
+        
+        if (s == 0 && buildOnBase) {
+            pipeline.emplace_back(new LeftBuildHashJoinOperator(collectRows(*table, q->where, scanColumns),
+                                                                compactIndex[step.leftColumn], buildKey,
+                                                                step.mixedKeyClasses, step.joinType, probeColumns));
+            scanColumns = buildColumns;
+            continue;
+        }
+        pipeline.emplace_back(new HashJoinOperator(collectRows(*step.table, Condition(), buildColumns),
+                                                   compactIndex[step.leftColumn], buildKey,
+                                                   step.mixedKeyClasses, step.joinType, probeColumns, buildSide));
+    }
+    
+    if (aggregating) {
+        for (size_t& idx : groupByIndices) idx = compactIndex[idx];
+        for (auto& spec : aggregateSpecs) {
+            if (spec.kind != AggregateKind::COUNT_STAR) spec.column = compactIndex[spec.column];
+        }
+        pipeline.emplace_back(new AggregateOperator(groupByIndices, aggregateSpecs));
+        if (reorderGroupRows) pipeline.emplace_back(new ProjectOperator(groupRowColumns));
+    } else {
+        for (auto& spec : sortSpecs) spec.column = compactIndex[spec.column];
+        for (size_t& idx : selectedIndices) idx = compactIndex[idx];
+    }
+    
+    if (!sortSpecs.empty()) {
+        if (q->hasLimit) {
+            // Only the best offset + n rows are kept
+            size_t rowsNeeded = q->limit > SIZE_MAX - q->offset ? SIZE_MAX : q->offset + q->limit;
+            pipeline.emplace_back(new TopNOperator(sortSpecs, rowsNeeded));
+        } else {
+            // Sorted runs spill under the storage path once the buffered rows
+            // exceed the memory budget
+            pipeline.emplace_back(new SortOperator(sortSpecs, db.getSortMemoryBudget(), db.getTempPath()));
+        }
+    }
+    
+    // Handle LIMIT / OFFSET; once the limit is reached the scan stops early
+    if (q->hasLimit) {
+        pipeline.emplace_back(new LimitOperator(q->offset, q->limit));
     }
+    
+    if (!selectAll && !aggregating) {
+        pipeline.emplace_back(new ProjectOperator(selectedIndices));
+    }
+
+    // Link the operators and run the scan through them
+    CollectOperator* sink = new CollectOperator();
+    pipeline.emplace_back(sink);
+    for (size_t i = 0; i + 1 < pipeline.size(); ++i) {
+        pipeline[i]->setNext(pipeline[i + 1].get());
+    }
+    if (buildOnBase) {
+        scanTable(*joinSteps[0].table, Condition(), scanColumns, *pipeline.front());
+    } else {
+        scanTable(*table, q->where, scanColumns, *pipeline.front());
+    }
+    vector<Row>& projectedRows = sink->rows;
 
     // Call the result callback if set
     if(!(resultColumns.size()==0 && projectedRows.size()==0))
@@ -680,6 +586,10 @@ void QueryExecutor::executeInsert(InsertQuery* q, Database& db) {
         error("Table not found: " + q->tableName);
         return;
     }
+    if (table->isExternal()) {
+        error("External table is read-only: " + q->tableName);
+        return;
+    }
 
     // If specific columns are specified, use insertPartialRow
     if (!q->specifiedColumns.empty()) {
@@ -695,13 +605,13 @@ void QueryExecutor::executeInsert(InsertQuery* q, Database& db) {
             // Validate type compatibility
             if (!q->values.values[i].isValidForType(columns[colIdx].type)) {
                 error("Type mismatch for column '" + q->specifiedColumns[i] + 
-                      "': cannot insert value '" + q->values.values[i].data + 
+                      "': cannot insert value '" + q->values.values[i].toString() + 
                       "' into " + getTypeName(columns[colIdx].type) + " column");
                 return;
             }
         }
         
-        if (!table->insertPartialRow(q->specifiedColumns, q->values)) {
+        if (!table->insertPartialRow(q->specifiedColumns, q->values, &db)) {
             error("Failed to insert row: constraint violation");
             return;
         }
@@ -719,18 +629,16 @@ void QueryExecutor::executeInsert(InsertQuery* q, Database& db) {
         for (size_t i = 0; i < q->values.values.size(); ++i) {
             if (!q->values.values[i].isValidForType(columns[i].type)) {
                 error("Type mismatch for column '" + columns[i].name + 
-                      "': cannot insert value '" + q->values.values[i].data + 
+                      "': cannot insert value '" + q->values.values[i].toString() + 
                       "' into " + getTypeName(columns[i].type) + " column");
                 return;
             }
         }
         
-        if (!table->insertRow(q->values)) {
+        if (!table->insertRow(q->values, &db)) {
             error("Failed to insert row: constraint violation");
             return;
         }
-        if(!table->insertRow(q->values))
-            error("Error with keys");
     }
     
     // Save to CSV immediately
@@ -746,6 +654,10 @@ void QueryExecutor::executeUpdate(UpdateQuery* q, Database& db) {
         error("Table not found: " + q->tableName);
         return;
     }
+    if (table->isExternal()) {
+        error("External table is read-only: " + q->tableName);
+        return;
+    }
 
     // Validate SET columns exist and types match
     const auto& columns = table->getColumns();
@@ -772,7 +684,7 @@ void QueryExecutor::executeUpdate(UpdateQuery* q, Database& db) {
         // Validate type compatibility
         if (targetCol && !pair.second.isValidForType(targetCol->type)) {
             error("Type mismatch for column '" + pair.first + 
-                  "': cannot update with value '" + pair.second.data + 
+                  "': cannot update with value '" + pair.second.toString() + 
                   "' into " + getTypeName(targetCol->type) + " column");
             return;
         }
@@ -800,11 +712,13 @@ void QueryExecutor::executeUpdate(UpdateQuery* q, Database& db) {
         }
     }
 
-    table->updateRows(resolvedWhere, resolvedNewValues);
+    if (!table->updateRows(resolvedWhere, resolvedNewValues, &db)) {
+        error("Failed to update rows: constraint violation");
+        return;
+    }
     
-    // Save to CSV immediately
-    string csvPath = "data/" + q->tableName + ".csv";
-    table->saveToCSV(csvPath);
+    // Persist immediately, unless the write-ahead log already holds the change
+    if (!db.isLogging()) db.saveTable(q->tableName);
     
     output("Rows updated",true);
 }
@@ -815,6 +729,10 @@ void QueryExecutor::executeDelete(DeleteQuery* q, Database& db) {
         error("Table not found: " + q->tableName);
         return;
     }
+    if (table->isExternal()) {
+        error("External table is read-only: " + q->tableName);
+        return;
+    }
 
     // Resolve WHERE column aliases (modifies in place)
     Condition resolvedWhere = q->where;
@@ -838,21 +756,33 @@ void QueryExecutor::executeDelete(DeleteQuery* q, Database& db) {
 
     table->deleteRows(resolvedWhere);
     
-    // Save to CSV immediately
-    string csvPath = "data/" + q->tableName + ".csv";
-    table->saveToCSV(csvPath);
+    // Persist immediately, unless the write-ahead log already holds the change
+    if (!db.isLogging()) db.saveTable(q->tableName);
     
     output("Rows deleted",true);
 }
 
 void QueryExecutor::executeCreateTable(CreateTableQuery* q, Database& db) {
     // Check if table already exists
-    if (db.getTable(q->tableName)) {
+    if (db.hasTable(q->tableName)) {
         error("Table already exists: " + q->tableName);
         return;
     }
 
-    db.createTable(q->tableName, q->columns);
+    if (!q->externalPath.empty()) {
+        try {
+            db.createExternalTable(q->tableName, q->externalPath);
+        } catch (const exception& e) {
+            error(e.what());
+            return;
+        }
+        output("External table '" + q->tableName + "' created on " + q->externalPath + " (" +
+               to_string(db.getTableColumns(q->tableName)->size()) + " columns)", true);
+        tree();
+        return;
+    }
+
+    db.createTable(q->tableName, q->columns, q->storageMode);
     output("Table '" + q->tableName + "' created successfully",true);
     tree();
 }
@@ -862,7 +792,7 @@ void QueryExecutor::executeDropTable(DropTableQuery* q, Database& db) {
     
     for (const auto& tableName : q->tableNames) {
         // Check if table exists
-        if (!db.getTable(tableName)) {
+        if (!db.hasTable(tableName)) {
             if (!q->ifExists) {
                 error("Table not found: " + tableName);
                 return;
@@ -886,3 +816,54 @@ void QueryExecutor::executeDropTable(DropTableQuery* q, Database& db) {
         output("No tables to drop",true);
     }
 }
+
+void QueryExecutor::executeCreateIndex(CreateIndexQuery* q, Database& db) {
+    Table* table = db.getTable(q->tableName);
+    if (!table) {
+        error("Table not found: " + q->tableName);
+        return;
+    }
+    if (table->isExternal()) {
+        error("External table is read-only: " + q->tableName);
+        return;
+    }
+
+    if (db.findTableByIndex(q->indexName)) {
+        error("Index already exists: " + q->indexName);
+        return;
+    }
+
+    if (table->getColumnIndex(q->columnName) == static_cast<size_t>(-1)) {
+        error("Column not found: " + q->columnName);
+        return;
+    }
+
+    table->createIndex(q->indexName, q->columnName);
+    output("Index '" + q->indexName + "' created on " + q->tableName + "(" + q->columnName + ")",true);
+}
+
+void QueryExecutor::executeDropIndex(DropIndexQuery* q, Database& db) {
+    Table* table = q->tableName.empty() ? db.findTableByIndex(q->indexName) : db.getTable(q->tableName);
+    if (!table || !table->hasIndex(q->indexName)) {
+        error("Index not found: " + q->indexName);
+        return;
+    }
+
+    table->dropIndex(q->indexName);
+    output("Index '" + q->indexName + "' dropped successfully",true);
+}
+
+void QueryExecutor::executeCopy(CopyQuery* q, Database& db) {
+    Table* table = db.getTable(q->tableName);
+    if (!table) {
+        error("Table not found: " + q->tableName);
+        return;
+    }
+
+    try {
+        size_t imported = table->importCSV(q->filePath, &db);
+        output(to_string(imported) + " rows imported into " + q->tableName, true);
+    } catch (const exception& e) {
+        error(string("Import failed: ") + e.what());
+    }
+}
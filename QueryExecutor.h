@@ -8,6 +8,9 @@
 #include "DeleteQuery.h"
 #include "CreateTableQuery.h"
 #include "DropTableQuery.h"
+#include "CreateIndexQuery.h"
+#include "DropIndexQuery.h"
+#include "CopyQuery.h"
 #include <functional>
 using namespace std;
 
@@ -33,6 +36,9 @@ private:
     void executeDelete(DeleteQuery* q, Database& db);
     void executeCreateTable(CreateTableQuery* q, Database& db);
     void executeDropTable(DropTableQuery* q, Database& db);
+    void executeCreateIndex(CreateIndexQuery* q, Database& db);
+    void executeDropIndex(DropIndexQuery* q, Database& db);
+    void executeCopy(CopyQuery* q, Database& db);
 
     OutputCallback output = [](const string& s,const bool focus) {};
     ErrorCallback error = [](const string& s) {};
@@ -34,6 +34,9 @@ public:
     vector<string> groupBy;
     vector<SortRule> orderBy;
     vector<JoinClause> joins;
+    bool hasLimit;      // LIMIT n [OFFSET m]
+    size_t limit;
+    size_t offset;
 
-    SelectQuery() { type = QueryType::SELECT; }
+    SelectQuery() : hasLimit(false), limit(0), offset(0) { type = QueryType::SELECT; }
 };
@@ -0,0 +1,162 @@
+// src/SortKey.cpp
+#include "SortKey.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+const char NUMBER_CLASS = 0x01;
+const char TEXT_CLASS = 0x02;
+const char NULL_CLASS = 0x03;
+}
+
+void SortKey::appendUint64(string& out, uint64_t v) {
+    // Big-endian so byte order matches numeric order
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>((v >> shift) & 0xFF));
+    }
+}
+
+void SortKey::append(string& out, const Value& v, bool ascending) {
+    size_t start = out.size();
+
+    if (v.isNull) {
+        out.push_back(NULL_CLASS);
+    } else if (v.isNumeric()) {
+        out.push_back(NUMBER_CLASS);
+
+        // Integers beyond 2^53 round when converted; the residual restores
+        // their exact order against each other and against nearby doubles
+        double d = v.asDouble();
+        int64_t residual = 0;
+        if (v.type == DataType::INTEGER) {
+            if (d >= 9223372036854775808.0) {
+                residual = (v.intValue - INT64_MAX) - 1;
+            } else {
+                residual = v.intValue - static_cast<int64_t>(d);
+            }
+        }
+        if (d == 0) d = 0; // -0.0 and 0.0 compare equal
+
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        // Flip the sign bit of positives and all bits of negatives so the
+        // unsigned order of the bits is the numeric order
+        bits = (bits & 0x8000000000000000ULL) ? ~bits : (bits | 0x8000000000000000ULL);
+        appendUint64(out, bits);
+        appendUint64(out, static_cast<uint64_t>(residual) ^ 0x8000000000000000ULL);
+    } else {
+        out.push_back(TEXT_CLASS);
+        // 0x00 is escaped as 0x00 0xFF and the string ends with 0x00 0x01, so a
+        // string sorts before any longer string it is a prefix of
+        for (char c : v.data) {
+            out.push_back(c);
+            if (c == '\0') out.push_back(static_cast<char>(0xFF));
+        }
+        out.push_back('\0');
+        out.push_back(0x01);
+    }
+
+    if (!ascending) {
+        for (size_t i = start; i < out.size(); ++i) {
+            out[i] = static_cast<char>(~out[i]);
+        }
+    }
+}
+
+void SortKey::encode(const Row& row, const vector<SortKeySpec>& specs, string& out) {
+    out.clear();
+    for (const auto& spec : specs) {
+        if (spec.column < row.values.size()) {
+            append(out, row.values[spec.column], spec.ascending);
+        } else {
+            append(out, Value::createNull(), spec.ascending);
+        }
+    }
+}
+
+int SortKey::compare(const char* a, size_t aLen, const char* b, size_t bLen) {
+    int c = memcmp(a, b, min(aLen, bLen));
+    if (c != 0) return c < 0 ? -1 : 1;
+    return aLen < bLen ? -1 : (aLen > bLen ? 1 : 0);
+}
+
+vector<size_t> SortKey::sortedOrder(const vector<Row>& rows, const vector<SortKeySpec>& specs) {
+    // All keys live in one buffer; offsets[i]..offsets[i + 1] is row i's key
+    string bytes;
+    vector<size_t> offsets;
+    offsets.reserve(rows.size() + 1);
+    offsets.push_back(0);
+    string key;
+    for (const auto& row : rows) {
+        encode(row, specs, key);
+        bytes += key;
+        offsets.push_back(bytes.size());
+    }
+
+    vector<size_t> order(rows.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+
+    const char* base = bytes.data();
+    stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return compare(base + offsets[a], offsets[a + 1] - offsets[a],
+                       base + offsets[b], offsets[b + 1] - offsets[b]) < 0;
+    });
+    return order;
+}
+
+void SortKey::sortRows(vector<Row>& rows, const vector<SortKeySpec>& specs) {
+    if (rows.size() < 2 || specs.empty()) return;
+
+    vector<size_t> order = sortedOrder(rows, specs);
+    vector<Row> sorted;
+    sorted.reserve(rows.size());
+    for (size_t i : order) {
+        sorted.push_back(move(rows[i]));
+    }
+    rows = move(sorted);
+}
+
+void SortKey::topRows(vector<Row>& rows, const vector<SortKeySpec>& specs, size_t n) {
+    if (n >= rows.size()) {
+        sortRows(rows, specs);
+        return;
+    }
+    if (specs.empty()) {
+        rows.resize(n);
+        return;
+    }
+
+    // Max-heap of the best n (key, position) pairs seen so far; the position
+    // breaks ties so the result matches a stable sort
+    typedef pair<string, size_t> Entry;
+    auto less = [](const Entry& a, const Entry& b) {
+        int c = compare(a.first, b.first);
+        return c != 0 ? c < 0 : a.second < b.second;
+    };
+    vector<Entry> heap;
+    heap.reserve(n);
+    string key;
+    for (size_t i = 0; i < rows.size() && n > 0; ++i) {
+        encode(rows[i], specs, key);
+        if (heap.size() < n) {
+            heap.emplace_back(key, i);
+            push_heap(heap.begin(), heap.end(), less);
+        } else if (compare(key, heap.front().first) < 0) {
+            // Later rows never win a tie, so only a strictly smaller key enters
+            pop_heap(heap.begin(), heap.end(), less);
+            heap.back().first.swap(key);
+            heap.back().second = i;
+            push_heap(heap.begin(), heap.end(), less);
+        }
+    }
+
+    sort_heap(heap.begin(), heap.end(), less);
+    vector<Row> top;
+    top.reserve(heap.size());
+    for (const auto& entry : heap) {
+        top.push_back(move(rows[entry.second]));
+    }
+    rows = move(top);
+}
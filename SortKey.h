@@ -0,0 +1,51 @@
+// include/SortKey.h
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "Value.h"
+#include "Row.h"
+
+using namespace std;
+
+struct SortKeySpec {
+    size_t column;
+    bool ascending;
+};
+
+// Byte-normalized ORDER BY keys. Each row's sort columns are encoded once into
+// a byte string whose memcmp order is the ORDER BY order, so sorting compares
+// bytes instead of re-dispatching on Value types.
+//
+// Per column: a class byte (numbers < text < NULL), then the payload.
+// Numbers are an order-preserving double plus an integer residual, so INTEGER
+// and FLOAT values interleave exactly; text is escaped and terminated so no key
+// is a prefix of another. DESC columns have all of their bytes inverted, which
+// also puts NULLs first for DESC and last for ASC.
+class SortKey {
+public:
+    // Appends the encoding of one value
+    static void append(string& out, const Value& v, bool ascending);
+
+    // Replaces 'out' with the full key of 'row'
+    static void encode(const Row& row, const vector<SortKeySpec>& specs, string& out);
+
+    // memcmp order of two encoded keys (shorter key first on a common prefix)
+    static int compare(const char* a, size_t aLen, const char* b, size_t bLen);
+    static int compare(const string& a, const string& b) {
+        return compare(a.data(), a.size(), b.data(), b.size());
+    }
+
+    // Row positions in ORDER BY order; ties keep their input order
+    static vector<size_t> sortedOrder(const vector<Row>& rows, const vector<SortKeySpec>& specs);
+
+    // Sorts rows in place by 'specs' (stable)
+    static void sortRows(vector<Row>& rows, const vector<SortKeySpec>& specs);
+
+    // Keeps only the first 'n' rows of the sorted order, in order, using a
+    // bounded heap of n keys instead of sorting every row
+    static void topRows(vector<Row>& rows, const vector<SortKeySpec>& specs, size_t n);
+
+private:
+    static void appendUint64(string& out, uint64_t v);
+};
@@ -1,18 +1,34 @@
 // src/Table.cpp
 #include "Table.h"
 #include "Database.h"
+#include "BatchFilter.h"
+#include "ThreadPool.h"
+#include "TableFile.h"
+#include "MappedFile.h"
+#include "CSVScanner.h"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <unordered_set>
+#include <iterator>
+#include <stdexcept>
 
 using namespace std;
 
-Table::Table() {
+Table::Table()
+    : storageMode(StorageMode::ROW), unmappedMode(StorageMode::ROW), dirty(true), logSequence(0), redoLog(nullptr),
+      foreignKeyRefsVersion(static_cast<size_t>(-1)) {
     rebuildIndexMap();
 }
 
-Table::Table(const string& n, const vector<Column>& cols) : name(n), columns(cols) {
+Table::Table(const string& n, const vector<Column>& cols, StorageMode mode)
+    : name(n), columns(cols),
+      storageMode(mode == StorageMode::MAPPED || mode == StorageMode::EXTERNAL ? StorageMode::COLUMNAR : mode),
+      unmappedMode(storageMode), dirty(true), logSequence(0), redoLog(nullptr),
+      foreignKeyRefsVersion(static_cast<size_t>(-1)) {
     rebuildIndexMap();
+    columnStore.write().reset(columns);
+    rebuildHashIndexes();
 }
 
 void Table::rebuildIndexMap() {
@@ -22,57 +38,476 @@ void Table::rebuildIndexMap() {
     }
 }
 
+void Table::rebuildHashIndexes() {
+    // Every PRIMARY KEY / UNIQUE column gets a hash index so constraint
+    // checks are a single probe instead of a scan over all rows. Indexes
+    // built on demand for foreign key targets are kept as well.
+    vector<size_t> indexedColumns;
+    for (const auto& pair : hashIndexes) {
+        if (pair.first < columns.size()) indexedColumns.push_back(pair.first);
+    }
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (columns[i].isPrimaryKey || columns[i].isUnique) {
+            indexedColumns.push_back(i);
+        }
+    }
+    hashIndexes.clear();
+    for (size_t col : indexedColumns) {
+        hashIndexes.emplace(col, HashIndex(col));
+    }
+
+    size_t rowCount = getRowCount();
+    for (auto& pair : hashIndexes) {
+        HashIndex& index = pair.second;
+        index.reserve(rowCount);
+        for (size_t rowId = 0; rowId < rowCount; ++rowId) {
+            index.insert(getValue(rowId, index.getColumnIndex()), rowId);
+        }
+    }
+}
+
+void Table::rebuildSecondaryIndexes() {
+    for (auto it = secondaryIndexes.begin(); it != secondaryIndexes.end();) {
+        SecondaryIndex& index = it->second;
+        size_t colIdx = getColumnIndex(index.columnName);
+        if (colIdx == static_cast<size_t>(-1)) {
+            it = secondaryIndexes.erase(it); // Indexed column no longer exists
+            continue;
+        }
+        index.columnIndex = colIdx;
+        index.offClassCount = 0;
+
+        vector<pair<Value, size_t>> entries;
+        size_t rowCount = getRowCount();
+        entries.reserve(rowCount);
+        for (size_t rowId = 0; rowId < rowCount; ++rowId) {
+            Value key = getValue(rowId, colIdx);
+            if (key.isNull) continue;
+            if (fitsIndex(index, key)) {
+                entries.emplace_back(move(key), rowId);
+            } else {
+                ++index.offClassCount;
+            }
+        }
+        index.tree.bulkLoad(move(entries));
+        ++it;
+    }
+}
+
+bool Table::fitsIndex(const SecondaryIndex& index, const Value& key) const {
+    // Numbers and text do not share one ordering, so only keys of the column's
+    // own class go into the tree
+    return key.isNumeric() == Value::isNumericType(columns[index.columnIndex].type);
+}
+
+void Table::addIndexKey(SecondaryIndex& index, const Value& key, size_t rowId) {
+    if (key.isNull) return;
+    if (fitsIndex(index, key)) {
+        index.tree.insert(key, rowId);
+    } else {
+        ++index.offClassCount;
+    }
+}
+
+void Table::removeIndexKey(SecondaryIndex& index, const Value& key, size_t rowId) {
+    if (key.isNull) return;
+    if (fitsIndex(index, key)) {
+        index.tree.erase(key, rowId);
+    } else if (index.offClassCount > 0) {
+        --index.offClassCount;
+    }
+}
+
+bool Table::createIndex(const string& indexName, const string& columnName) {
+    if (storageMode == StorageMode::EXTERNAL) return false;
+    size_t colIdx = getColumnIndex(columnName);
+    if (colIdx == static_cast<size_t>(-1)) return false;
+    if (secondaryIndexes.find(indexName) != secondaryIndexes.end()) return false;
+
+    SecondaryIndex index;
+    index.name = indexName;
+    index.columnName = columnName;
+    index.columnIndex = colIdx;
+    secondaryIndexes.emplace(indexName, move(index));
+    rebuildSecondaryIndexes();
+    if (redoLog) logSequence = redoLog->logCreateIndex(name, indexName, columnName);
+    return true;
+}
+
+bool Table::dropIndex(const string& indexName) {
+    if (secondaryIndexes.erase(indexName) == 0) return false;
+    if (redoLog) logSequence = redoLog->logDropIndex(name, indexName);
+    return true;
+}
+
+bool Table::hasIndex(const string& indexName) const {
+    return secondaryIndexes.find(indexName) != secondaryIndexes.end();
+}
+
+vector<pair<string, string>> Table::getIndexDefinitions() const {
+    vector<pair<string, string>> definitions;
+    for (const auto& pair : secondaryIndexes) {
+        definitions.emplace_back(pair.first, pair.second.columnName);
+    }
+    return definitions;
+}
+
+const SecondaryIndex* Table::findIndexOnColumn(size_t colIdx) const {
+    for (const auto& pair : secondaryIndexes) {
+        if (pair.second.columnIndex == colIdx) return &pair.second;
+    }
+    return nullptr;
+}
+
+bool Table::indexedRowIds(const Condition& c, vector<size_t>& rowIds) const {
+    // Collects a sorted superset of the matching row ids from the indexes.
+    // Returns false when some part of the condition needs a full scan.
+    if (c.logicalOp != LogicalOperator::NONE) {
+        if (!c.left || !c.right) return false;
+        vector<size_t> leftIds, rightIds;
+        bool leftIndexed = indexedRowIds(*c.left, leftIds);
+        bool rightIndexed = indexedRowIds(*c.right, rightIds);
+
+        if (c.logicalOp == LogicalOperator::AND) {
+            if (leftIndexed && rightIndexed) {
+                rowIds.clear();
+                set_intersection(leftIds.begin(), leftIds.end(), rightIds.begin(), rightIds.end(),
+                                 back_inserter(rowIds));
+            } else if (leftIndexed) {
+                rowIds = move(leftIds);
+            } else if (rightIndexed) {
+                rowIds = move(rightIds);
+            } else {
+                return false;
+            }
+            return true;
+        }
+        if (c.logicalOp == LogicalOperator::OR && leftIndexed && rightIndexed) {
+            rowIds.clear();
+            set_union(leftIds.begin(), leftIds.end(), rightIds.begin(), rightIds.end(),
+                      back_inserter(rowIds));
+            return true;
+        }
+        return false;
+    }
+
+    if (c.column.empty()) return false;
+    size_t colIdx = getColumnIndex(c.column);
+    if (colIdx == static_cast<size_t>(-1)) return false;
+
+    bool isRange = c.op == "<" || c.op == ">" || c.op == "<=" || c.op == ">=";
+    if (c.op != "=" && !isRange) return false;
+
+    if (c.value.isNull) {
+        rowIds.clear(); // Comparisons with NULL match nothing
+        return true;
+    }
+    // Mixed number/text comparisons do not follow the index order
+    if (c.value.isNumeric() != Value::isNumericType(columns[colIdx].type)) return false;
+
+    const SecondaryIndex* index = findIndexOnColumn(colIdx);
+    if (c.op == "=") {
+        auto hashIt = hashIndexes.find(colIdx);
+        if (hashIt != hashIndexes.end()) {
+            rowIds = hashIt->second.find(c.value);
+        } else if (index) {
+            rowIds = index->tree.find(c.value);
+        } else {
+            return false;
+        }
+    } else {
+        // Off-class keys are not in the tree and may still satisfy a range
+        if (!index || index->offClassCount > 0) return false;
+        if (c.op == "<") rowIds = index->tree.range(nullptr, false, &c.value, false);
+        else if (c.op == "<=") rowIds = index->tree.range(nullptr, false, &c.value, true);
+        else if (c.op == ">") rowIds = index->tree.range(&c.value, false, nullptr, false);
+        else rowIds = index->tree.range(&c.value, true, nullptr, false);
+    }
+    sort(rowIds.begin(), rowIds.end());
+    return true;
+}
+
+void Table::forEachMatchingMorsel(const Condition& c, size_t waveSize,
+                                  const function<bool(vector<size_t>&)>& fn) const {
+    // Column names and operators are resolved once here, not per row
+    BoundCondition bound = BoundCondition::bind(c, columns);
+    vector<size_t> candidates;
+    if (indexedRowIds(c, candidates)) {
+        // Candidates are re-checked since AND keeps only one indexed side
+        vector<size_t> ids;
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (rowMatches(bound, candidates[i])) ids.push_back(candidates[i]);
+            if (ids.size() == MORSEL_SIZE || (i + 1 == candidates.size() && !ids.empty())) {
+                if (!fn(ids)) return;
+                ids.clear();
+            }
+        }
+        return;
+    }
+
+    size_t rowCount = getRowCount();
+    size_t morselCount = (rowCount + MORSEL_SIZE - 1) / MORSEL_SIZE;
+    if (bound.matchesAll()) {
+        vector<size_t> ids;
+        for (size_t morselBegin = 0; morselBegin < rowCount; morselBegin += MORSEL_SIZE) {
+            size_t morselEnd = min(rowCount, morselBegin + MORSEL_SIZE);
+            ids.resize(morselEnd - morselBegin);
+            for (size_t rowId = morselBegin; rowId < morselEnd; ++rowId) ids[rowId - morselBegin] = rowId;
+            if (!fn(ids)) return;
+        }
+        return;
+    }
+
+    // Full scan: a wave of morsels is filtered in parallel, one block at a
+    // time, then the morsels' results are handed over in row order
+    waveSize = max<size_t>(1, min(waveSize, morselCount));
+    vector<vector<size_t>> morselResults;
+    for (size_t waveBegin = 0; waveBegin < morselCount; waveBegin += waveSize) {
+        size_t waveEnd = min(morselCount, waveBegin + waveSize);
+        morselResults.assign(waveEnd - waveBegin, vector<size_t>());
+        ThreadPool::instance().parallelFor(waveEnd - waveBegin, [&](size_t task) {
+            size_t morselBegin = (waveBegin + task) * MORSEL_SIZE;
+            size_t morselEnd = min(rowCount, morselBegin + MORSEL_SIZE);
+            BatchFilter batchFilter(bound);
+            vector<uint32_t> selection;
+            vector<size_t>& out = morselResults[task];
+            for (size_t begin = morselBegin; begin < morselEnd; begin += BATCH_SIZE) {
+                size_t count = min(BATCH_SIZE, morselEnd - begin);
+                if (storageMode == StorageMode::COLUMNAR) {
+                    batchFilter.filter(*columnStore, begin, count, selection);
+                } else if (storageMode == StorageMode::MAPPED) {
+                    batchFilter.filter(*mappedFile, begin, count, selection);
+                } else if (storageMode == StorageMode::EXTERNAL) {
+                    vector<Row> block;
+                    block.reserve(count);
+                    for (size_t rowId = begin; rowId < begin + count; ++rowId) {
+                        block.push_back(csvFile->getRow(rowId));
+                    }
+                    batchFilter.filter(block, 0, count, selection);
+                } else {
+                    batchFilter.filter(*rows, begin, count, selection);
+                }
+                for (uint32_t offset : selection) {
+                    out.push_back(begin + offset);
+                }
+            }
+        });
+        for (auto& ids : morselResults) {
+            if (!ids.empty() && !fn(ids)) return;
+        }
+    }
+}
+
+vector<size_t> Table::matchingRowIds(const Condition& c, size_t limit) const {
+    vector<size_t> result;
+    if (limit == 0) return result;
+    // Without a limit every morsel is filtered in one parallel wave; with one,
+    // waves of one morsel per thread stop as soon as enough rows qualify
+    size_t waveSize = limit == SIZE_MAX ? SIZE_MAX : ThreadPool::instance().getDegreeOfParallelism();
+    forEachMatchingMorsel(c, waveSize, [&](vector<size_t>& ids) {
+        size_t take = min(ids.size(), limit - result.size());
+        result.insert(result.end(), ids.begin(), ids.begin() + take);
+        return result.size() < limit;
+    });
+    return result;
+}
+
+const HashIndex& Table::ensureHashIndex(size_t colIdx) {
+    auto it = hashIndexes.find(colIdx);
+    if (it != hashIndexes.end()) return it->second;
+
+    HashIndex& index = hashIndexes.emplace(colIdx, HashIndex(colIdx)).first->second;
+    size_t rowCount = getRowCount();
+    index.reserve(rowCount);
+    for (size_t rowId = 0; rowId < rowCount; ++rowId) {
+        index.insert(getValue(rowId, colIdx), rowId);
+    }
+    return index;
+}
+
+bool Table::containsKey(size_t colIdx, const Value& key) {
+    if (key.isNull || colIdx >= columns.size()) return false;
+    if (key.type == columns[colIdx].type) {
+        return ensureHashIndex(colIdx).contains(key);
+    }
+    // Probe with the key in the column's own type
+    return ensureHashIndex(colIdx).contains(key.convertTo(columns[colIdx].type));
+}
+
+void Table::indexRow(const Row& r, size_t rowId) {
+    for (auto& pair : hashIndexes) {
+        if (pair.first < r.values.size()) {
+            pair.second.insert(r.values[pair.first], rowId);
+        }
+    }
+    for (auto& pair : secondaryIndexes) {
+        SecondaryIndex& index = pair.second;
+        if (index.columnIndex < r.values.size()) {
+            addIndexKey(index, r.values[index.columnIndex], rowId);
+        }
+    }
+}
+
+void Table::coerceToColumnTypes(Row& r) const {
+    // Decode values into their column's type once, at insert/update time
+    for (size_t i = 0; i < r.values.size() && i < columns.size(); ++i) {
+        if (r.values[i].type != columns[i].type) {
+            r.values[i] = r.values[i].convertTo(columns[i].type);
+        }
+    }
+}
+
+void Table::setStorageMode(StorageMode mode) {
+    if (mode == storageMode || mode == StorageMode::MAPPED || mode == StorageMode::EXTERNAL) return;
+    if (storageMode == StorageMode::EXTERNAL) return;
+
+    if (storageMode == StorageMode::MAPPED) {
+        // Copy the mapped rows into memory and release the file
+        size_t rowCount = mappedFile->getRowCount();
+        if (mode == StorageMode::COLUMNAR) {
+            ColumnStore& store = columnStore.write();
+            store.reset(columns);
+            store.reserve(rowCount);
+            for (size_t rowId = 0; rowId < rowCount; ++rowId) {
+                store.appendRow(mappedFile->getRow(rowId));
+            }
+        } else {
+            vector<Row>& data = rows.write();
+            data.reserve(rowCount);
+            for (size_t rowId = 0; rowId < rowCount; ++rowId) {
+                data.push_back(mappedFile->getRow(rowId));
+            }
+        }
+        mappedFile.reset();
+        storageMode = mode;
+        rebuildHashIndexes();
+        return;
+    }
+
+    if (mode == StorageMode::COLUMNAR) {
+        columnStore.discard();
+        ColumnStore& store = columnStore.write();
+        store.reset(columns);
+        store.reserve(rows->size());
+        for (const auto& row : *rows) {
+            store.appendRow(row);
+        }
+        rows.discard();
+    } else {
+        rows.discard();
+        vector<Row>& data = rows.write();
+        data.reserve(columnStore->rowCount());
+        for (size_t rowId = 0; rowId < columnStore->rowCount(); ++rowId) {
+            data.push_back(columnStore->getRow(rowId));
+        }
+        columnStore.discard();
+        columnStore.write().reset(columns);
+    }
+    storageMode = mode;
+}
+
+size_t Table::getRowCount() const {
+    switch (storageMode) {
+        case StorageMode::COLUMNAR: return columnStore->rowCount();
+        case StorageMode::MAPPED: return mappedFile->getRowCount();
+        case StorageMode::EXTERNAL: return csvFile->getRowCount();
+        default: return rows->size();
+    }
+}
+
+Row Table::getRow(size_t rowId) const {
+    switch (storageMode) {
+        case StorageMode::COLUMNAR: return columnStore->getRow(rowId);
+        case StorageMode::MAPPED: return mappedFile->getRow(rowId);
+        case StorageMode::EXTERNAL: return csvFile->getRow(rowId);
+        default: return (*rows)[rowId];
+    }
+}
+
+Value Table::getValue(size_t rowId, size_t colIdx) const {
+    if (storageMode == StorageMode::COLUMNAR) {
+        return columnStore->getValue(rowId, colIdx);
+    }
+    if (storageMode == StorageMode::MAPPED) {
+        return mappedFile->getValue(rowId, colIdx);
+    }
+    if (storageMode == StorageMode::EXTERNAL) {
+        return csvFile->getValue(rowId, colIdx);
+    }
+    const Row& row = (*rows)[rowId];
+    return colIdx < row.values.size() ? row.values[colIdx] : Value::createNull(columns[colIdx].type);
+}
+
+void Table::appendRow(Row&& r) {
+    if (storageMode == StorageMode::COLUMNAR) {
+        columnStore.write().appendRow(r);
+    } else {
+        rows.write().push_back(move(r));
+    }
+}
+
+bool Table::rowMatches(const BoundCondition& c, size_t rowId) const {
+    if (storageMode == StorageMode::COLUMNAR) {
+        // Only the columns referenced by the condition are touched
+        return c.evaluate(*columnStore, rowId);
+    }
+    if (storageMode == StorageMode::MAPPED) {
+        return c.evaluate(*mappedFile, rowId);
+    }
+    if (storageMode == StorageMode::EXTERNAL) {
+        return c.evaluate(csvFile->getRow(rowId));
+    }
+    return c.evaluate((*rows)[rowId]);
+}
+
 bool Table::validatePrimaryKey(const Row& r) const {
     // Check each column that is a primary key
     for (size_t i = 0; i < columns.size(); ++i) {
         if (columns[i].isPrimaryKey) {
             // Check if this value already exists in existing rows
-            for (const auto& existingRow : rows) {
-                if (i < r.values.size() && i < existingRow.values.size()) {
-                    if (existingRow.values[i].data == r.values[i].data) {
-                        return false; // Duplicate primary key found
-                    }
-                }
+            auto it = hashIndexes.find(i);
+            if (it != hashIndexes.end() && i < r.values.size() && it->second.contains(r.values[i])) {
+                return false; // Duplicate primary key found
             }
         }
     }
     return true; // No duplicates found
 }
 
+void Table::resolveForeignKeys(Database* db) const {
+    // Resolve foreignTable/foreignColumn once per catalog version instead of
+    // a db->getTable map lookup per validated row
+    foreignKeyRefs.assign(columns.size(), ForeignKeyRef{nullptr, static_cast<size_t>(-1)});
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (!columns[i].isForeignKey) continue;
+        Table* refTable = db->getTable(columns[i].foreignTable);
+        if (!refTable) continue;
+        foreignKeyRefs[i] = ForeignKeyRef{refTable, refTable->getColumnIndex(columns[i].foreignColumn)};
+    }
+    foreignKeyRefsVersion = db->getCatalogVersion();
+}
+
 bool Table::validateForeignKeys(const Row& r, Database* db) const {
     if (!db) return true; // Can't validate without database reference
     
+    if (foreignKeyRefsVersion != db->getCatalogVersion() || foreignKeyRefs.size() != columns.size()) {
+        resolveForeignKeys(db);
+    }
+    
     // Check each column that is a foreign key
     for (size_t i = 0; i < columns.size(); ++i) {
         if (columns[i].isForeignKey) {
-            // Get the referenced table
-            Table* refTable = db->getTable(columns[i].foreignTable);
-            if (!refTable) {
+            const ForeignKeyRef& ref = foreignKeyRefs[i];
+            if (!ref.table) {
                 return false; // Referenced table doesn't exist
             }
-            
-            // Find the referenced column index
-            size_t refColIdx = refTable->getColumnIndex(columns[i].foreignColumn);
-            if (refColIdx == static_cast<size_t>(-1)) {
+            if (ref.columnIndex == static_cast<size_t>(-1)) {
                 return false; // Referenced column doesn't exist
             }
             
-            // Check if the value exists in the referenced table
-            if (i < r.values.size()) {
-                const string& fkValue = r.values[i].data;
-                bool found = false;
-                
-                const auto& refRows = refTable->getRows();
-                for (const auto& refRow : refRows) {
-                    if (refColIdx < refRow.values.size()) {
-                        if (refRow.values[refColIdx].data == fkValue) {
-                            found = true;
-                            break;
-                        }
-                    }
-                }
-                
-                if (!found && !fkValue.empty()) {
+            // Check if the value exists in the referenced table (NULL references nothing)
+            if (i < r.values.size() && !r.values[i].isNull) {
+                if (!ref.table->containsKey(ref.columnIndex, r.values[i])) {
                     return false; // Foreign key value doesn't exist in referenced table
                 }
             }
@@ -85,21 +520,12 @@ bool Table::validateUniqueConstraints(const Row& r, size_t excludeRowIdx) const
     // Check each column that has UNIQUE constraint
     for (size_t i = 0; i < columns.size(); ++i) {
         if (columns[i].isUnique || columns[i].isPrimaryKey) {
-            // Check if this value already exists in existing rows
-            for (size_t rowIdx = 0; rowIdx < rows.size(); ++rowIdx) {
-                // Skip the row being updated
-                if (rowIdx == excludeRowIdx) continue;
-                
-                if (i < r.values.size() && i < rows[rowIdx].values.size()) {
-                    // Skip NULL values (NULL is unique)
-                    if (r.values[i].isNull || rows[rowIdx].values[i].isNull) {
-                        continue;
-                    }
-                    
-                    if (rows[rowIdx].values[i].data == r.values[i].data) {
-                        return false; // Duplicate unique value found
-                    }
-                }
+            // Probe the column's hash index, skipping the row being updated.
+            // NULL values are never indexed (NULL is unique)
+            auto it = hashIndexes.find(i);
+            if (it != hashIndexes.end() && i < r.values.size() &&
+                it->second.containsOtherThan(r.values[i], excludeRowIdx)) {
+                return false; // Duplicate unique value found
             }
         }
     }
@@ -108,22 +534,32 @@ bool Table::validateUniqueConstraints(const Row& r, size_t excludeRowIdx) const
 
 bool Table::insertRow(const Row& r, Database* db) {
     if (r.values.size() != columns.size()) return false; // Error handling
+    if (storageMode == StorageMode::EXTERNAL) return false; // Read-only
+    if (storageMode == StorageMode::MAPPED) setStorageMode(unmappedMode);
+    
+    Row typedRow = r;
+    coerceToColumnTypes(typedRow);
     
     // Validate unique constraints (including primary key)
-    if (!validateUniqueConstraints(r, static_cast<size_t>(-1))) {
+    if (!validateUniqueConstraints(typedRow, static_cast<size_t>(-1))) {
         return false; // Duplicate unique/primary key
     }
     
     // Validate foreign key constraints
-    if (!validateForeignKeys(r, db)) {
+    if (!validateForeignKeys(typedRow, db)) {
         return false; // Foreign key violation
     }
     
-    rows.push_back(r);
+    if (redoLog) logSequence = redoLog->logInsert(name, typedRow);
+    indexRow(typedRow, getRowCount());
+    appendRow(move(typedRow));
+    dirty = true;
     return true;
 }
 
 bool Table::insertPartialRow(const vector<string>& columnNames, const Row& values, Database* db) {
+    if (storageMode == StorageMode::EXTERNAL) return false; // Read-only
+    if (storageMode == StorageMode::MAPPED) setStorageMode(unmappedMode);
     Row fullRow;
     fullRow.values.resize(columns.size());
     
@@ -139,6 +575,7 @@ bool Table::insertPartialRow(const vector<string>& columnNames, const Row& value
             fullRow.values[it->second] = values.values[i];
         }
     }
+    coerceToColumnTypes(fullRow);
     
     // Validate unique constraints (including primary key)
     if (!validateUniqueConstraints(fullRow, static_cast<size_t>(-1))) {
@@ -150,7 +587,10 @@ bool Table::insertPartialRow(const vector<string>& columnNames, const Row& value
         return false; // Foreign key violation
     }
     
-    rows.push_back(fullRow);
+    if (redoLog) logSequence = redoLog->logInsert(name, fullRow);
+    indexRow(fullRow, getRowCount());
+    appendRow(move(fullRow));
+    dirty = true;
     return true;
 }
 
@@ -162,174 +602,633 @@ size_t Table::getColumnIndex(const string& columnName) const {
     return static_cast<size_t>(-1); // Not found
 }
 
-vector<Row> Table::selectRows(const Condition& c) const {
-    vector<Row> result;
-    for (const auto& row : rows) {
-        if (c.evaluate(row, columns)) {
-            result.push_back(row);
-        }
+void Table::scanRows(const Condition& c, const vector<size_t>& outputColumns,
+                     const function<bool(vector<Row>&)>& consumer) const {
+    if (storageMode == StorageMode::EXTERNAL) {
+        scanExternal(BoundCondition::bind(c, columns), outputColumns, consumer);
+        return;
     }
+    // One wave of morsels per thread bounds the rows in flight
+    size_t waveSize = ThreadPool::instance().getDegreeOfParallelism();
+    forEachMatchingMorsel(c, waveSize, [&](vector<size_t>& ids) {
+        vector<Row> batch(ids.size());
+        parallelForRange(ids.size(), BATCH_SIZE, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                vector<Value>& values = batch[i].values;
+                values.reserve(outputColumns.size());
+                for (size_t col : outputColumns) {
+                    values.push_back(getValue(ids[i], col));
+                }
+            }
+        });
+        return consumer(batch);
+    });
+}
+
+vector<Row> Table::selectRows(const Condition& c, size_t limit) const {
+    vector<size_t> rowIds = matchingRowIds(c, limit);
+    vector<Row> result(rowIds.size());
+    parallelForRange(rowIds.size(), MORSEL_SIZE, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            result[i] = getRow(rowIds[i]);
+        }
+    });
     return result;
 }
 
 bool Table::updateRows(const Condition& c, const map<string, Value>& nv, Database* db) {
+    if (storageMode == StorageMode::EXTERNAL) return false; // Read-only
+    // Resolve the assigned columns once
+    vector<size_t> assignedColumns;
+    for (const auto& pair : nv) {
+        auto it = columnIndexMap.find(pair.first);
+        if (it != columnIndexMap.end()) {
+            assignedColumns.push_back(it->second);
+        }
+    }
+    
     // First, collect rows that match the condition and prepare updated versions
-    vector<size_t> matchingIndices;
+    vector<size_t> matchingIndices = matchingRowIds(c);
+    if (matchingIndices.empty()) return true;
+    if (storageMode == StorageMode::MAPPED) setStorageMode(unmappedMode);
     vector<Row> updatedRows;
+    updatedRows.reserve(matchingIndices.size());
     
-    for (size_t idx = 0; idx < rows.size(); ++idx) {
-        if (c.evaluate(rows[idx], columns)) {
-            matchingIndices.push_back(idx);
-            Row updatedRow = rows[idx];
-            
-            // Apply updates
-            for (const auto& pair : nv) {
-                auto it = columnIndexMap.find(pair.first);
-                if (it != columnIndexMap.end()) {
-                    updatedRow.values[it->second] = pair.second;
-                }
+    for (size_t idx : matchingIndices) {
+        Row updatedRow = getRow(idx);
+        
+        // Apply updates
+        for (const auto& pair : nv) {
+            auto it = columnIndexMap.find(pair.first);
+            if (it != columnIndexMap.end()) {
+                updatedRow.values[it->second] = pair.second.convertTo(columns[it->second].type);
             }
-            
-            updatedRows.push_back(updatedRow);
         }
+        
+        updatedRows.push_back(move(updatedRow));
     }
     
-    // Validate all updated rows
-    for (size_t i = 0; i < updatedRows.size(); ++i) {
-        const Row& updatedRow = updatedRows[i];
-        size_t originalIdx = matchingIndices[i];
+    // Check unique constraints (including primary key) on the assigned columns.
+    // Every matched row leaves its old key, so a new key conflicts only with a
+    // row outside the update or with another updated row.
+    for (size_t col : assignedColumns) {
+        if (!columns[col].isPrimaryKey && !columns[col].isUnique) continue;
+        auto indexIt = hashIndexes.find(col);
+        if (indexIt == hashIndexes.end()) continue;
         
-        // Check unique constraints (including primary key)
-        if (!validateUniqueConstraints(updatedRow, originalIdx)) {
-            return false; // Duplicate unique/primary key
+        unordered_set<Value, ValueHash, ValueEqual> newKeys;
+        for (const auto& updatedRow : updatedRows) {
+            const Value& key = updatedRow.values[col];
+            if (key.isNull) continue;
+            if (!newKeys.insert(key).second) {
+                return false; // Two updated rows would share the key
+            }
+            for (size_t holder : indexIt->second.find(key)) {
+                if (!binary_search(matchingIndices.begin(), matchingIndices.end(), holder)) {
+                    return false; // Duplicate unique/primary key
+                }
+            }
         }
-        
-        // Validate foreign keys
-        if (!validateForeignKeys(updatedRow, db)) {
+    }
+    
+    // Validate foreign keys, only needed when an FK column is assigned
+    bool assignsForeignKey = false;
+    for (size_t col : assignedColumns) {
+        if (columns[col].isForeignKey) assignsForeignKey = true;
+    }
+    for (size_t i = 0; assignsForeignKey && i < updatedRows.size(); ++i) {
+        if (!validateForeignKeys(updatedRows[i], db)) {
             return false; // Foreign key violation
         }
     }
     
     // If all validations pass, apply the updates
-    for (size_t i = 0; i < matchingIndices.size(); ++i) {
-        rows[matchingIndices[i]] = updatedRows[i];
-    }
-    
+    if (redoLog) logSequence = redoLog->logUpdate(name, assignedColumns, matchingIndices, updatedRows);
+    applyUpdates(matchingIndices, assignedColumns, updatedRows);
     return true;
 }
 
+void Table::applyUpdates(const vector<size_t>& rowIds, const vector<size_t>& assignedColumns, vector<Row>& updatedRows) {
+    for (size_t i = 0; i < rowIds.size(); ++i) {
+        size_t rowId = rowIds[i];
+        
+        // Move changed keys in the hash indexes
+        for (auto& pair : hashIndexes) {
+            if (find(assignedColumns.begin(), assignedColumns.end(), pair.first) == assignedColumns.end()) continue;
+            pair.second.erase(getValue(rowId, pair.first), rowId);
+            pair.second.insert(updatedRows[i].values[pair.first], rowId);
+        }
+        for (auto& pair : secondaryIndexes) {
+            SecondaryIndex& index = pair.second;
+            if (find(assignedColumns.begin(), assignedColumns.end(), index.columnIndex) == assignedColumns.end()) continue;
+            removeIndexKey(index, getValue(rowId, index.columnIndex), rowId);
+            addIndexKey(index, updatedRows[i].values[index.columnIndex], rowId);
+        }
+        
+        if (storageMode == StorageMode::COLUMNAR) {
+            // Only the assigned columns are written back
+            for (size_t col : assignedColumns) {
+                columnStore.write().setValue(rowId, col, updatedRows[i].values[col]);
+            }
+        } else {
+            rows.write()[rowId] = move(updatedRows[i]);
+        }
+    }
+    dirty = true;
+}
+
 void Table::deleteRows(const Condition& c) {
-    rows.erase(remove_if(rows.begin(), rows.end(), [&](const Row& row) {
-        return c.evaluate(row, columns);
-    }), rows.end());
+    if (storageMode == StorageMode::EXTERNAL) return; // Read-only
+    vector<size_t> matchingIndices = matchingRowIds(c);
+    if (matchingIndices.empty()) return;
+    if (redoLog) logSequence = redoLog->logDelete(name, matchingIndices);
+    eraseRows(matchingIndices);
 }
 
-void Table::loadFromCSV(const string& filePath) {
-    ifstream file(filePath);
-    if (!file.is_open()) return;
+void Table::eraseRows(const vector<size_t>& matchingIndices) {
+    if (storageMode == StorageMode::MAPPED) setStorageMode(unmappedMode);
 
-    string line;
-    // Read column names
-    if (getline(file, line)) {
-        stringstream ss(line);
-        string colName;
-        columns.clear();
-        while (getline(ss, colName, ',')) {
-            columns.emplace_back(colName, DataType::STRING); // Assume STRING for now
+    // Erasing each deleted key and relabelling the survivors costs O(N log D)
+    // against O(N log N) for a rebuild; once most rows go, a rebuild over the
+    // few survivors is cheaper
+    bool rebuild = matchingIndices.size() * 2 > getRowCount();
+    if (!rebuild) {
+        for (size_t rowId : matchingIndices) {
+            for (auto& pair : hashIndexes) {
+                if (pair.first < columns.size()) pair.second.erase(getValue(rowId, pair.first), rowId);
+            }
+            for (auto& pair : secondaryIndexes) {
+                SecondaryIndex& index = pair.second;
+                removeIndexKey(index, getValue(rowId, index.columnIndex), rowId);
+            }
         }
     }
 
-    // Read types if present (current code has types in second line)
-    if (getline(file, line)) {
-        stringstream ss(line);
-        string typeStr;
-        size_t idx = 0;
-        while (getline(ss, typeStr, ',') && idx < columns.size()) {
-            if (typeStr == "INT") columns[idx].type = DataType::INTEGER;
-            else if (typeStr == "VARCHAR") columns[idx].type = DataType::VARCHAR;
-            else if (typeStr == "FLOAT") columns[idx].type = DataType::FLOAT;
-            else if (typeStr == "BOOL") columns[idx].type = DataType::BOOLEAN;
-            else columns[idx].type = DataType::STRING;
-            ++idx;
+    if (storageMode == StorageMode::COLUMNAR) {
+        columnStore.write().eraseRows(matchingIndices);
+    } else {
+        // Compact surviving rows towards the front
+        vector<Row>& data = rows.write();
+        size_t write = 0;
+        size_t nextErase = 0;
+        for (size_t read = 0; read < data.size(); ++read) {
+            if (nextErase < matchingIndices.size() && matchingIndices[nextErase] == read) {
+                ++nextErase;
+                continue;
+            }
+            if (write != read) data[write] = move(data[read]);
+            ++write;
         }
+        data.resize(write);
     }
+    
+    dirty = true;
 
-    // Read primary key flags
-    if (getline(file, line)) {
-        stringstream ss(line);
-        string pkFlag;
-        size_t idx = 0;
-        while (getline(ss, pkFlag, ',') && idx < columns.size()) {
-            columns[idx].isPrimaryKey = (pkFlag == "1");
-            ++idx;
+    // Surviving rows shift down past the erased ones
+    if (rebuild) {
+        rebuildHashIndexes();
+        rebuildSecondaryIndexes();
+        return;
+    }
+    for (auto& pair : hashIndexes) {
+        pair.second.renumber(matchingIndices);
+    }
+    for (auto& pair : secondaryIndexes) {
+        pair.second.tree.renumber(matchingIndices);
+    }
+}
+
+void Table::redo(const LogRecord& record) {
+    if (storageMode == StorageMode::EXTERNAL) return; // Never logged
+    switch (record.type) {
+        case LogRecordType::INSERT: {
+            if (record.rows[0].values.size() != columns.size()) return;
+            if (storageMode == StorageMode::MAPPED) setStorageMode(unmappedMode);
+            Row row = record.rows[0];
+            indexRow(row, getRowCount());
+            appendRow(move(row));
+            dirty = true;
+            break;
+        }
+        case LogRecordType::UPDATE: {
+            for (size_t col : record.columnIds) {
+                if (col >= columns.size()) return;
+            }
+            // Rebuild full rows from the logged values of the assigned columns
+            vector<size_t> rowIds;
+            vector<Row> updatedRows;
+            for (size_t i = 0; i < record.rowIds.size(); ++i) {
+                if (record.rowIds[i] >= getRowCount()) continue;
+                rowIds.push_back(record.rowIds[i]);
+                updatedRows.push_back(getRow(record.rowIds[i]));
+                for (size_t k = 0; k < record.columnIds.size(); ++k) {
+                    updatedRows.back().values[record.columnIds[k]] = record.rows[i].values[k];
+                }
+            }
+            if (storageMode == StorageMode::MAPPED) setStorageMode(unmappedMode);
+            applyUpdates(rowIds, record.columnIds, updatedRows);
+            break;
+        }
+        case LogRecordType::DELETE: {
+            vector<size_t> rowIds;
+            for (size_t rowId : record.rowIds) {
+                if (rowId < getRowCount()) rowIds.push_back(rowId);
+            }
+            if (!rowIds.empty()) eraseRows(rowIds);
+            break;
         }
+        case LogRecordType::CREATE_INDEX:
+            createIndex(record.indexName, record.columnName);
+            break;
+        case LogRecordType::DROP_INDEX:
+            dropIndex(record.indexName);
+            break;
+        default:
+            return;
+    }
+    logSequence = record.sequence;
+}
+
+// Minimum CSV data per parse task; smaller files are parsed on the caller
+static const size_t CSV_CHUNK_BYTES = 1 << 20;
+
+// Cuts the CSV records in [begin, end) into chunks of about equal size for
+// parallel parsing: chunk c is [bounds[c], bounds[c + 1]). Every cut lands on
+// a record start; the parity of the quotes before a cut, counted in parallel,
+// tells whether it falls inside a quoted field.
+static vector<const char*> splitCSVRecords(const char* begin, const char* end) {
+    size_t bytes = end - begin;
+    size_t chunkCount = min(ThreadPool::instance().getDegreeOfParallelism() * 4, bytes / CSV_CHUNK_BYTES);
+    if (chunkCount <= 1) return {begin, end};
+
+    vector<const char*> cuts(chunkCount + 1, end);
+    for (size_t c = 0; c < chunkCount; ++c) cuts[c] = begin + bytes / chunkCount * c;
+    vector<size_t> quotes(chunkCount);
+    ThreadPool::instance().parallelFor(chunkCount, [&](size_t c) {
+        quotes[c] = CSVScanner::countQuotes(cuts[c], cuts[c + 1]);
+    });
+
+    vector<const char*> bounds(chunkCount + 1, end);
+    bounds[0] = begin;
+    size_t quotesBefore = 0;
+    for (size_t c = 1; c < chunkCount; ++c) {
+        quotesBefore += quotes[c - 1];
+        const char* start = CSVScanner::nextRecordStart(cuts[c], end, (quotesBefore & 1) != 0);
+        bounds[c] = max(bounds[c - 1], start);
     }
+    return bounds;
+}
 
-    // Read unique flags
-    if (getline(file, line)) {
-        stringstream ss(line);
-        string uniqueFlag;
-        size_t idx = 0;
-        while (getline(ss, uniqueFlag, ',') && idx < columns.size()) {
-            columns[idx].isUnique = (uniqueFlag == "1");
-            ++idx;
+void Table::loadFromCSV(const string& filePath) {
+    unique_ptr<MappedFile> mapping;
+    try {
+        mapping.reset(new MappedFile(filePath));
+    } catch (const exception&) {
+        return;
+    }
+    const char* data = mapping->data();
+    const char* dataEnd = data + mapping->size();
+
+    // Seven header lines: column names, types, primary key, unique and
+    // foreign key flags, foreign tables and foreign columns
+    CSVScanner header(data, dataEnd);
+    vector<vector<string>> headerLines;
+    vector<CSVField> fields;
+    while (headerLines.size() < 7 && header.nextRecord(fields)) {
+        vector<string> line;
+        if (!CSVScanner::isBlank(fields)) {
+            for (const auto& field : fields) line.push_back(field.text());
         }
+        headerLines.push_back(move(line));
     }
+    headerLines.resize(7);
 
-    // Read foreign key flags
-    if (getline(file, line)) {
-        stringstream ss(line);
-        string fkFlag;
-        size_t idx = 0;
-        while (getline(ss, fkFlag, ',') && idx < columns.size()) {
-            columns[idx].isForeignKey = (fkFlag == "1");
-            ++idx;
+    // Read column names
+    columns.clear();
+    for (const auto& colName : headerLines[0]) {
+        columns.emplace_back(colName, DataType::STRING); // Assume STRING for now
+    }
+
+    // Read types if present (current code has types in second line)
+    for (size_t idx = 0; idx < headerLines[1].size() && idx < columns.size(); ++idx) {
+        const string& typeStr = headerLines[1][idx];
+        if (typeStr == "INT") columns[idx].type = DataType::INTEGER;
+        else if (typeStr == "VARCHAR") columns[idx].type = DataType::VARCHAR;
+        else if (typeStr == "FLOAT") columns[idx].type = DataType::FLOAT;
+        else if (typeStr == "BOOL") columns[idx].type = DataType::BOOLEAN;
+        else columns[idx].type = DataType::STRING;
+    }
+
+    // Read primary key, unique and foreign key flags
+    for (size_t idx = 0; idx < headerLines[2].size() && idx < columns.size(); ++idx) {
+        columns[idx].isPrimaryKey = (headerLines[2][idx] == "1");
+    }
+    for (size_t idx = 0; idx < headerLines[3].size() && idx < columns.size(); ++idx) {
+        columns[idx].isUnique = (headerLines[3][idx] == "1");
+    }
+    for (size_t idx = 0; idx < headerLines[4].size() && idx < columns.size(); ++idx) {
+        columns[idx].isForeignKey = (headerLines[4][idx] == "1");
+    }
+
+    // Read foreign table and column names
+    for (size_t idx = 0; idx < headerLines[5].size() && idx < columns.size(); ++idx) {
+        columns[idx].foreignTable = headerLines[5][idx];
+    }
+    for (size_t idx = 0; idx < headerLines[6].size() && idx < columns.size(); ++idx) {
+        columns[idx].foreignColumn = headerLines[6][idx];
+    }
+
+    rebuildIndexMap();
+    hashIndexes.clear();
+    foreignKeyRefs.clear();
+
+    // Read rows
+    rows.discard();
+    columnStore.discard();
+    columnStore.write().reset(columns);
+    if (storageMode == StorageMode::MAPPED) {
+        mappedFile.reset();
+        storageMode = unmappedMode;
+    }
+
+    // Large files are cut into chunks at record boundaries and parsed in
+    // parallel, each into its own rows or column store; the chunks are then
+    // joined in file order. Missing trailing fields are NULL.
+    vector<const char*> bounds = splitCSVRecords(header.position(), dataEnd);
+    size_t chunkCount = bounds.size() - 1;
+    bool columnar = (storageMode == StorageMode::COLUMNAR);
+    vector<vector<Row>> chunkRows(chunkCount);
+    vector<ColumnStore> chunkStores(chunkCount);
+    ThreadPool::instance().parallelFor(chunkCount, [&](size_t c) {
+        CSVScanner scanner(bounds[c], bounds[c + 1]);
+        vector<CSVField> recordFields;
+        ColumnStore& store = chunkStores[c];
+        if (columnar) store.reset(columns);
+        while (scanner.nextRecord(recordFields)) {
+            if (columns.empty() || CSVScanner::isBlank(recordFields)) continue;
+            if (columnar) {
+                // Fields are parsed straight into the typed column arrays
+                for (size_t i = 0; i < columns.size(); ++i) {
+                    ColumnVector& column = store.appendTarget(i);
+                    if (i < recordFields.size()) appendCSVValue(column, recordFields[i]);
+                    else column.appendNull();
+                }
+                store.commitAppendedRow();
+            } else {
+                Row row;
+                row.values.reserve(columns.size());
+                for (size_t i = 0; i < columns.size(); ++i) {
+                    // Parsed into the column's type once, here at load time
+                    row.values.push_back(i < recordFields.size() ? parseCSVValue(columns[i].type, recordFields[i])
+                                                                 : Value::createNull(columns[i].type));
+                }
+                chunkRows[c].push_back(move(row));
+            }
+        }
+    });
+
+    if (columnar) {
+        for (auto& store : chunkStores) {
+            columnStore.write().appendRows(move(store));
         }
+    } else {
+        size_t total = 0;
+        for (const auto& chunk : chunkRows) total += chunk.size();
+        vector<Row>& data = rows.write();
+        data.reserve(total);
+        for (auto& chunk : chunkRows) {
+            data.insert(data.end(), make_move_iterator(chunk.begin()), make_move_iterator(chunk.end()));
+        }
+    }
+    dirty = true; // Not yet in a table file
+
+    rebuildHashIndexes();
+    rebuildSecondaryIndexes();
+}
+
+size_t Table::importCSV(const string& filePath, Database* db) {
+    if (storageMode == StorageMode::EXTERNAL) {
+        throw runtime_error("External table is read-only: " + name);
     }
+    MappedFile file(filePath);
+    const char* data = file.data();
+    const char* dataEnd = data + file.size();
 
-    // Read foreign table names
-    if (getline(file, line)) {
-        stringstream ss(line);
-        string fTable;
-        size_t idx = 0;
-        while (getline(ss, fTable, ',') && idx < columns.size()) {
-            columns[idx].foreignTable = fTable;
-            ++idx;
+    // The header line names the columns present; the others are NULL
+    CSVScanner header(data, dataEnd);
+    vector<CSVField> fields;
+    if (!header.nextRecord(fields) || CSVScanner::isBlank(fields)) {
+        throw runtime_error("CSV file has no header line: " + filePath);
+    }
+    vector<size_t> fileColumns; // Table column of each field
+    for (const auto& field : fields) {
+        size_t colIdx = getColumnIndex(field.text());
+        if (colIdx == static_cast<size_t>(-1)) {
+            throw runtime_error("Column not found: " + field.text());
         }
+        fileColumns.push_back(colIdx);
     }
 
-    // Read foreign column names
-    if (getline(file, line)) {
-        stringstream ss(line);
-        string fColumn;
-        size_t idx = 0;
-        while (getline(ss, fColumn, ',') && idx < columns.size()) {
-            columns[idx].foreignColumn = fColumn;
-            ++idx;
+    // Records are parsed in parallel, then checked and appended in file order
+    vector<const char*> bounds = splitCSVRecords(header.position(), dataEnd);
+    size_t chunkCount = bounds.size() - 1;
+    vector<vector<Row>> chunkRows(chunkCount);
+    ThreadPool::instance().parallelFor(chunkCount, [&](size_t c) {
+        CSVScanner scanner(bounds[c], bounds[c + 1]);
+        vector<CSVField> recordFields;
+        while (scanner.nextRecord(recordFields)) {
+            if (CSVScanner::isBlank(recordFields)) continue;
+            Row row;
+            row.values.reserve(columns.size());
+            for (const auto& col : columns) {
+                row.values.push_back(Value::createNull(col.type));
+            }
+            for (size_t i = 0; i < recordFields.size() && i < fileColumns.size(); ++i) {
+                size_t colIdx = fileColumns[i];
+                row.values[colIdx] = parseCSVValue(columns[colIdx].type, recordFields[i]);
+            }
+            chunkRows[c].push_back(move(row));
+        }
+    });
+
+    // Like a run of INSERTs: rows before a failing record stay imported
+    if (storageMode == StorageMode::MAPPED) setStorageMode(unmappedMode);
+    size_t imported = 0;
+    for (auto& chunk : chunkRows) {
+        for (auto& row : chunk) {
+            auto record = [&]() {
+                return "record " + to_string(imported + 1) + " (" + to_string(imported) + " rows imported)";
+            };
+            for (size_t i = 0; i < columns.size(); ++i) {
+                // Text that did not parse as the column's type came back as a STRING
+                if (!row.values[i].isNull && row.values[i].type != columns[i].type) {
+                    throw runtime_error("Type mismatch for column '" + columns[i].name + "' in " + record());
+                }
+            }
+            if (!validateUniqueConstraints(row, static_cast<size_t>(-1)) || !validateForeignKeys(row, db)) {
+                throw runtime_error("Constraint violation in " + record());
+            }
+
+            if (redoLog) logSequence = redoLog->logInsert(name, row);
+            indexRow(row, getRowCount());
+            appendRow(move(row));
+            dirty = true;
+            ++imported;
         }
     }
+    return imported;
+}
+
+void Table::loadFromBinary(const string& filePath) {
+    TableFile file(filePath);
+    columns = file.getColumns();
 
     rebuildIndexMap();
+    hashIndexes.clear();
+    foreignKeyRefs.clear();
 
-    // Read rows
-    rows.clear();
-    while (getline(file, line)) {
-        stringstream ss(line);
-        string valStr;
-        Row row;
-        size_t idx = 0;
-        while (getline(ss, valStr, ',')) {
-            if (idx < columns.size()) {
-                // Check if value is "null" (case-insensitive)
-                if (valStr == "null" || valStr == "NULL") {
-                    row.values.push_back(Value::createNull(columns[idx].type));
+    rows.discard();
+    columnStore.discard();
+    columnStore.write().reset(columns);
+    if (storageMode == StorageMode::MAPPED) {
+        mappedFile.reset();
+        storageMode = unmappedMode;
+    }
+    if (storageMode == StorageMode::COLUMNAR) {
+        columnStore.write().reserve(file.getRowCount());
+    } else {
+        rows.write().reserve(file.getRowCount());
+    }
+    file.readRows([this](Row&& row) { appendRow(move(row)); });
+    dirty = false;
+    logSequence = file.getLogSequence();
+
+    rebuildHashIndexes();
+    rebuildSecondaryIndexes();
+}
+
+void Table::saveToBinary(const string& filePath, const function<void(size_t)>& throttle) const {
+    // A mapped table is unmodified, and its file cannot be rewritten while mapped
+    if (storageMode == StorageMode::MAPPED && mappedFile->getPath() == filePath) return;
+    TableFile::write(filePath, *this, throttle);
+}
+
+Table Table::snapshot() const {
+    Table copy;
+    copy.name = name;
+    copy.columns = columns;
+    copy.rows = rows;
+    copy.columnStore = columnStore;
+    copy.mappedFile = mappedFile;
+    copy.csvFile = csvFile;
+    copy.storageMode = storageMode;
+    copy.unmappedMode = unmappedMode;
+    copy.dirty = dirty;
+    copy.logSequence = logSequence;
+    copy.rebuildIndexMap();
+    return copy;
+}
+
+void Table::mapFromBinary(const string& filePath) {
+    auto file = make_shared<const TableFile>(filePath, true);
+    columns = file->getColumns();
+
+    rebuildIndexMap();
+    hashIndexes.clear();
+    foreignKeyRefs.clear();
+
+    rows.discard();
+    columnStore.discard();
+    columnStore.write().reset(columns);
+    mappedFile = move(file);
+    if (storageMode != StorageMode::MAPPED) unmappedMode = storageMode;
+    storageMode = StorageMode::MAPPED;
+    dirty = false;
+    logSequence = mappedFile->getLogSequence();
+
+    rebuildSecondaryIndexes();
+}
+
+void Table::attachCSV(const string& filePath) {
+    auto file = make_shared<const CSVFile>(filePath);
+    columns = file->getColumns();
+
+    rebuildIndexMap();
+    hashIndexes.clear();
+    secondaryIndexes.clear();
+    foreignKeyRefs.clear();
+
+    rows.discard();
+    columnStore.discard();
+    columnStore.write().reset(columns);
+    mappedFile.reset();
+    csvFile = move(file);
+    storageMode = StorageMode::EXTERNAL;
+    dirty = false; // Nothing to save
+}
+
+void Table::scanExternal(const BoundCondition& c, const vector<size_t>& outputColumns,
+                         const function<bool(vector<Row>&)>& consumer) const {
+    // Only the columns the condition and the output read are decoded; the
+    // rest of each row stays unset
+    vector<size_t> decoded = outputColumns;
+    c.collectColumns(decoded);
+    sort(decoded.begin(), decoded.end());
+    decoded.erase(unique(decoded.begin(), decoded.end()), decoded.end());
+
+    // The file is read in waves of one chunk per thread, cut at record
+    // starts; each chunk is parsed and filtered in parallel and the matches
+    // are handed over in file order, so at most a wave of rows is in flight
+    size_t waveSize = ThreadPool::instance().getDegreeOfParallelism();
+    const char* dataEnd = csvFile->dataEnd();
+    const char* waveBegin = csvFile->dataBegin();
+    vector<vector<Row>> chunkResults;
+    while (waveBegin < dataEnd) {
+        vector<const char*> bounds{waveBegin};
+        while (bounds.size() <= waveSize && bounds.back() < dataEnd) {
+            bounds.push_back(CSVScanner::recordBoundary(bounds.back(), dataEnd, CSV_CHUNK_BYTES));
+        }
+        size_t chunkCount = bounds.size() - 1;
+        chunkResults.assign(chunkCount, vector<Row>());
+        ThreadPool::instance().parallelFor(chunkCount, [&](size_t chunk) {
+            CSVScanner scanner(bounds[chunk], bounds[chunk + 1]);
+            vector<CSVField> fields;
+            BatchFilter batchFilter(c);
+            vector<uint32_t> selection;
+            vector<Row> block;
+            vector<Row>& out = chunkResults[chunk];
+            auto flush = [&]() {
+                if (c.matchesAll()) {
+                    selection.resize(block.size());
+                    for (size_t i = 0; i < block.size(); ++i) selection[i] = static_cast<uint32_t>(i);
                 } else {
-                    row.values.emplace_back(columns[idx].type, valStr);
+                    batchFilter.filter(block, 0, block.size(), selection);
+                }
+                for (uint32_t offset : selection) {
+                    Row row;
+                    row.values.reserve(outputColumns.size());
+                    for (size_t col : outputColumns) row.values.push_back(block[offset].values[col]);
+                    out.push_back(move(row));
+                }
+                block.clear();
+            };
+            while (scanner.nextRecord(fields)) {
+                if (CSVScanner::isBlank(fields)) continue;
+                block.emplace_back();
+                vector<Value>& values = block.back().values;
+                values.resize(columns.size());
+                for (size_t col : decoded) {
+                    values[col] = col < fields.size() ? parseCSVValue(columns[col].type, fields[col])
+                                                      : Value::createNull(columns[col].type);
                 }
+                if (block.size() == BATCH_SIZE) flush();
             }
-            ++idx;
+            if (!block.empty()) flush();
+        });
+        for (auto& batch : chunkResults) {
+            if (!batch.empty() && !consumer(batch)) return;
         }
-        if (!row.values.empty()) rows.push_back(row);
+        waveBegin = bounds.back();
     }
 }
 
@@ -339,7 +1238,7 @@ void Table::saveToCSV(const string& filePath) const {
 
     // Write column names
     for (size_t i = 0; i < columns.size(); ++i) {
-        file << columns[i].name;
+        file << quoteCSVField(columns[i].name);
         if (i < columns.size() - 1) file << ",";
     }
     file << "\n";
@@ -382,26 +1281,27 @@ void Table::saveToCSV(const string& filePath) const {
 
     // Write foreign table names
     for (size_t i = 0; i < columns.size(); ++i) {
-        file << columns[i].foreignTable;
+        file << quoteCSVField(columns[i].foreignTable);
         if (i < columns.size() - 1) file << ",";
     }
     file << "\n";
 
     // Write foreign column names
     for (size_t i = 0; i < columns.size(); ++i) {
-        file << columns[i].foreignColumn;
+        file << quoteCSVField(columns[i].foreignColumn);
         if (i < columns.size() - 1) file << ",";
     }
     file << "\n";
 
     // Write rows
-    for (const auto& row : rows) {
+    for (size_t rowId = 0; rowId < getRowCount(); ++rowId) {
+        Row row = getRow(rowId);
         for (size_t i = 0; i < row.values.size(); ++i) {
             // Write "null" for NULL values
             if (row.values[i].isNull) {
                 file << "null";
             } else {
-                file << row.values[i].data;
+                file << quoteCSVField(row.values[i].toString());
             }
             if (i < row.values.size() - 1) file << ",";
         }
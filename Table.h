@@ -3,42 +3,175 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include "Column.h"
 #include "Row.h"
 #include "Condition.h"
+#include "BoundCondition.h"
+#include "ColumnStore.h"
+#include "HashIndex.h"
+#include "BPlusTree.h"
+#include "TableFile.h"
+#include "WriteAheadLog.h"
+#include "CSVFile.h"
+#include "CopyOnWrite.h"
 
 using namespace std;
 
-// Forward declaration
+// Forward declarations
 class Database;
+class Table;
+
+// Foreign key target resolved to a table and column index
+struct ForeignKeyRef {
+    Table* table;
+    size_t columnIndex;
+};
+
+// Named ordered index created with CREATE INDEX
+struct SecondaryIndex {
+    string name;
+    string columnName;
+    size_t columnIndex;
+    BPlusTree tree;
+    size_t offClassCount; // Keys not stored because they are text in a numeric column (or vice versa)
+
+    SecondaryIndex() : columnIndex(0), offClassCount(0) {}
+};
 
 class Table {
 private:
     string name;
     vector<Column> columns;
-    vector<Row> rows;
+    // Shared with snapshots until the next change (see snapshot)
+    CopyOnWrite<vector<Row>> rows;          // Used in StorageMode::ROW
+    CopyOnWrite<ColumnStore> columnStore;   // Used in StorageMode::COLUMNAR
+    shared_ptr<const TableFile> mappedFile; // Used in StorageMode::MAPPED
+    shared_ptr<const CSVFile> csvFile;      // Used in StorageMode::EXTERNAL
+    StorageMode storageMode;
+    StorageMode unmappedMode;       // Mode a MAPPED table is copied into when modified
+    bool dirty;                     // Rows differ from the table file last loaded or saved
+    uint64_t logSequence;           // LSN of the last write-ahead log record applied
+    WriteAheadLog* redoLog;         // Receives a record per change; null while not logging
     map<string, size_t> columnIndexMap;
+    map<size_t, HashIndex> hashIndexes; // Column index -> hash index (PK/UNIQUE and FK targets)
+    map<string, SecondaryIndex> secondaryIndexes; // Index name -> B+tree index
+
+    // Per-column FK resolution, valid while the database catalog version matches
+    mutable vector<ForeignKeyRef> foreignKeyRefs;
+    mutable size_t foreignKeyRefsVersion;
 
     void rebuildIndexMap();
+    void rebuildHashIndexes();
+    void rebuildSecondaryIndexes();
+    void indexRow(const Row& r, size_t rowId);
+    bool fitsIndex(const SecondaryIndex& index, const Value& key) const;
+    void addIndexKey(SecondaryIndex& index, const Value& key, size_t rowId);
+    void removeIndexKey(SecondaryIndex& index, const Value& key, size_t rowId);
+    const SecondaryIndex* findIndexOnColumn(size_t colIdx) const;
+    bool indexedRowIds(const Condition& c, vector<size_t>& rowIds) const;
+    void forEachMatchingMorsel(const Condition& c, size_t waveSize,
+                               const function<bool(vector<size_t>&)>& fn) const;
+    vector<size_t> matchingRowIds(const Condition& c, size_t limit = SIZE_MAX) const;
+    void coerceToColumnTypes(Row& r) const;
+    void appendRow(Row&& r);
+    void applyUpdates(const vector<size_t>& rowIds, const vector<size_t>& assignedColumns, vector<Row>& updatedRows);
+    void eraseRows(const vector<size_t>& rowIds);
+    bool rowMatches(const BoundCondition& c, size_t rowId) const;
     bool validatePrimaryKey(const Row& r) const;
     bool validateUniqueConstraints(const Row& r, size_t excludeRowIdx) const;
     bool validateForeignKeys(const Row& r, Database* db) const;
+    void resolveForeignKeys(Database* db) const;
+    void scanExternal(const BoundCondition& c, const vector<size_t>& outputColumns,
+                      const function<bool(vector<Row>&)>& consumer) const;
 
 public:
     Table();
-    Table(const string& n, const vector<Column>& cols);
+    Table(const string& n, const vector<Column>& cols, StorageMode mode = StorageMode::ROW);
     string getName() const { return name; }
 
+    StorageMode getStorageMode() const { return storageMode; }
+    // A MAPPED table is copied into memory in the requested mode; MAPPED
+    // itself is only entered through mapFromBinary, and EXTERNAL (which is
+    // never left) through attachCSV
+    void setStorageMode(StorageMode mode);
+
     bool insertRow(const Row& r, Database* db = nullptr);
     bool insertPartialRow(const vector<string>& columnNames, const Row& values, Database* db = nullptr);
-    vector<Row> selectRows(const Condition& c) const;
+    // At most 'limit' matching rows, in row order; the scan stops once enough rows qualify
+    vector<Row> selectRows(const Condition& c, size_t limit = SIZE_MAX) const;
+    // Streams matching rows in row order, one morsel-sized batch at a time,
+    // until the consumer returns false. Rows hold only 'outputColumns', in that order.
+    void scanRows(const Condition& c, const vector<size_t>& outputColumns,
+                  const function<bool(vector<Row>&)>& consumer) const;
     bool updateRows(const Condition& c, const map<string, Value>& nv, Database* db = nullptr);
     void deleteRows(const Condition& c);
 
     void loadFromCSV(const string& filePath);
     void saveToCSV(const string& filePath) const;
+    // Bulk import (COPY): appends the records of a plain CSV file whose
+    // header line names the columns present, checking types and constraints
+    // like INSERT. Returns the number of rows added; throws runtime_error on
+    // an unreadable file, unknown column or bad record, keeping the rows
+    // before it.
+    size_t importCSV(const string& filePath, Database* db = nullptr);
+
+    // Native binary format (see TableFile); load throws runtime_error on a
+    // missing or corrupt file
+    void loadFromBinary(const string& filePath);
+    void saveToBinary(const string& filePath, const function<void(size_t)>& throttle = nullptr) const;
+
+    // Maps a table file instead of reading it (StorageMode::MAPPED): rows are
+    // read in place and pages are faulted in as queries touch them. The first
+    // modification copies the table into memory in the mode it had before;
+    // PRIMARY KEY/UNIQUE hash indexes are not built until then.
+    void mapFromBinary(const string& filePath);
+
+    // Queries a plain CSV file in place (StorageMode::EXTERNAL; see CSVFile):
+    // the columns come from its header line and inferred types, and scans
+    // stream the file, decoding only the columns the filter and projection
+    // read. The table is read-only. Throws runtime_error if the file cannot
+    // be opened.
+    void attachCSV(const string& filePath);
+    bool isExternal() const { return storageMode == StorageMode::EXTERNAL; }
+
+    // Set by every row change and by construction or CSV import; cleared by
+    // loading a table file and by markClean once the rows have been saved
+    bool isDirty() const { return dirty; }
+    void markClean() { dirty = false; }
+    void markDirty() { dirty = true; }
+
+    // The rows and schema only (no indexes), for saving while the table
+    // itself keeps changing. The rows are shared, not copied: the table's
+    // first change while the snapshot lives copies them instead.
+    Table snapshot() const;
+
+    // Write-ahead logging: every row and index change is logged before it is
+    // applied. The table file stores logSequence, so replay (redo) skips
+    // records the file already reflects.
+    void setRedoLog(WriteAheadLog* log) { redoLog = log; }
+    uint64_t getLogSequence() const { return logSequence; }
+    void setLogSequence(uint64_t sequence) { logSequence = sequence; }
+    // Re-applies a logged row or index change without constraint checks
+    void redo(const LogRecord& record);
 
     const vector<Column>& getColumns() const { return columns; }
-    const vector<Row>& getRows() const { return rows; }
     size_t getColumnIndex(const string& columnName) const;
+
+    // Hash index on a column, built on demand if the column is not PK/UNIQUE
+    const HashIndex& ensureHashIndex(size_t colIdx);
+    bool containsKey(size_t colIdx, const Value& key);
+
+    // Secondary indexes (CREATE INDEX / DROP INDEX)
+    bool createIndex(const string& indexName, const string& columnName);
+    bool dropIndex(const string& indexName);
+    bool hasIndex(const string& indexName) const;
+    vector<pair<string, string>> getIndexDefinitions() const; // (index name, column name)
+
+    // Row-id based access, valid in every storage mode
+    size_t getRowCount() const;
+    Row getRow(size_t rowId) const;
+    Value getValue(size_t rowId, size_t colIdx) const;
 };
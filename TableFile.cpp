@@ -0,0 +1,482 @@
+// src/TableFile.cpp
+#include "TableFile.h"
+#include "Table.h"
+#include "BinaryIO.h"
+#include "ThreadPool.h"
+#include "FileSync.h"
+#include <sstream>
+#include <stdexcept>
+#include <cstring>
+#include <filesystem>
+
+using namespace std;
+
+static const char MAGIC[8] = {'D', 'B', 'T', 'A', 'B', 'L', 'E', '\0'};
+static const size_t HEADER_SIZE = 64;
+static const size_t PAGE_HEADER_SIZE = 8;
+static const size_t DIRECTORY_ENTRY_SIZE = 16;
+
+enum class PageEncoding : uint8_t { TYPED = 0, GENERIC = 1 };
+
+// Payload layout of a column, as in ColumnStore
+enum class PhysicalType { INT64, DOUBLE, BOOL, TEXT };
+
+static PhysicalType physicalTypeOf(DataType type) {
+    switch (type) {
+        case DataType::INTEGER: return PhysicalType::INT64;
+        case DataType::FLOAT: return PhysicalType::DOUBLE;
+        case DataType::BOOLEAN: return PhysicalType::BOOL;
+        default: return PhysicalType::TEXT;
+    }
+}
+
+static bool fitsPhysicalType(const Value& v, PhysicalType p) {
+    if (v.isNull) return true;
+    switch (p) {
+        case PhysicalType::INT64: return v.type == DataType::INTEGER;
+        case PhysicalType::DOUBLE: return v.type == DataType::FLOAT;
+        case PhysicalType::BOOL: return v.type == DataType::BOOLEAN;
+        default: return !v.isNumeric();
+    }
+}
+
+static void appendString(string& out, const string& s) {
+    BinaryIO::appendUint32(out, static_cast<uint32_t>(s.size()));
+    out += s;
+}
+
+static void padTo8(string& out) {
+    out.append((8 - out.size() % 8) % 8, '\0');
+}
+
+// Encodes rows [first, first + n) of one column as a single page
+static void encodePage(const Table& table, size_t col, size_t first, size_t n, string& page) {
+    DataType type = table.getColumns()[col].type;
+    PhysicalType physical = physicalTypeOf(type);
+
+    vector<Value> values;
+    values.reserve(n);
+    bool typed = true;
+    uint64_t heapSize = 0;
+    for (size_t i = 0; i < n; ++i) {
+        values.push_back(table.getValue(first + i, col));
+        const Value& v = values.back();
+        typed = typed && fitsPhysicalType(v, physical);
+        if (physical == PhysicalType::TEXT && !v.isNull) heapSize += v.data.size();
+    }
+    // Heap offsets are 32-bit
+    if (heapSize > UINT32_MAX) typed = false;
+
+    page.clear();
+    BinaryIO::appendUint32(page, static_cast<uint32_t>(n));
+    page.push_back(static_cast<char>(typed ? PageEncoding::TYPED : PageEncoding::GENERIC));
+    page.append(3, '\0');
+
+    if (!typed) {
+        ostringstream generic;
+        for (const auto& v : values) BinaryIO::writeValue(generic, v);
+        page += generic.str();
+        return;
+    }
+
+    vector<uint64_t> nullBits((n + 63) / 64, 0);
+    for (size_t i = 0; i < n; ++i) {
+        if (values[i].isNull) nullBits[i >> 6] |= uint64_t(1) << (i & 63);
+    }
+    for (uint64_t word : nullBits) BinaryIO::appendUint64(page, word);
+
+    switch (physical) {
+        case PhysicalType::INT64:
+            for (const auto& v : values) {
+                BinaryIO::appendUint64(page, v.isNull ? 0 : static_cast<uint64_t>(v.intValue));
+            }
+            break;
+        case PhysicalType::DOUBLE:
+            for (const auto& v : values) {
+                uint64_t bits = 0;
+                if (!v.isNull) memcpy(&bits, &v.floatValue, sizeof(bits));
+                BinaryIO::appendUint64(page, bits);
+            }
+            break;
+        case PhysicalType::BOOL:
+            for (const auto& v : values) page.push_back(!v.isNull && v.boolValue ? 1 : 0);
+            break;
+        case PhysicalType::TEXT: {
+            uint32_t offset = 0;
+            BinaryIO::appendUint32(page, 0);
+            for (const auto& v : values) {
+                if (!v.isNull) offset += static_cast<uint32_t>(v.data.size());
+                BinaryIO::appendUint32(page, offset);
+            }
+            for (const auto& v : values) {
+                if (!v.isNull) page += v.data;
+            }
+            break;
+        }
+    }
+}
+
+void TableFile::write(const string& path, const Table& table, const function<void(size_t)>& throttle) {
+    const vector<Column>& columns = table.getColumns();
+    size_t rowCount = table.getRowCount();
+    size_t pageCount = (rowCount + ROWS_PER_PAGE - 1) / ROWS_PER_PAGE;
+
+    // Written beside the target and renamed over it, so a failed or
+    // interrupted save leaves the previous file intact
+    string tempPath = path + ".tmp";
+    ofstream out(tempPath, ios::binary | ios::trunc);
+    if (!out) {
+        throw runtime_error("Cannot create table file: " + tempPath);
+    }
+
+    string schema;
+    for (const auto& col : columns) {
+        appendString(schema, col.name);
+        schema.push_back(static_cast<char>(col.type));
+        schema.push_back(col.isPrimaryKey ? 1 : 0);
+        schema.push_back(col.isUnique ? 1 : 0);
+        schema.push_back(col.isForeignKey ? 1 : 0);
+        appendString(schema, col.foreignTable);
+        appendString(schema, col.foreignColumn);
+    }
+
+    // The header is written last, once the directory offset is known
+    string block(HEADER_SIZE, '\0');
+    block += schema;
+    padTo8(block);
+    out.write(block.data(), block.size());
+    uint64_t offset = block.size();
+
+    vector<PageEntry> directory(columns.size() * pageCount);
+    string page;
+    for (size_t col = 0; col < columns.size(); ++col) {
+        for (size_t p = 0; p < pageCount; ++p) {
+            size_t first = p * ROWS_PER_PAGE;
+            encodePage(table, col, first, min(ROWS_PER_PAGE, rowCount - first), page);
+            PageEntry& entry = directory[col * pageCount + p];
+            entry.offset = offset;
+            entry.length = static_cast<uint32_t>(page.size());
+            entry.crc = BinaryIO::crc32(page.data(), page.size());
+            padTo8(page);
+            out.write(page.data(), page.size());
+            offset += page.size();
+            if (throttle) throttle(page.size());
+        }
+    }
+
+    string dir;
+    dir.reserve(directory.size() * DIRECTORY_ENTRY_SIZE);
+    for (const auto& entry : directory) {
+        BinaryIO::appendUint64(dir, entry.offset);
+        BinaryIO::appendUint32(dir, entry.length);
+        BinaryIO::appendUint32(dir, entry.crc);
+    }
+    out.write(dir.data(), dir.size());
+
+    string header(MAGIC, sizeof(MAGIC));
+    BinaryIO::appendUint32(header, VERSION);
+    BinaryIO::appendUint32(header, static_cast<uint32_t>(columns.size()));
+    BinaryIO::appendUint64(header, rowCount);
+    BinaryIO::appendUint32(header, static_cast<uint32_t>(ROWS_PER_PAGE));
+    BinaryIO::appendUint32(header, static_cast<uint32_t>(schema.size()));
+    BinaryIO::appendUint64(header, offset);
+    BinaryIO::appendUint32(header, BinaryIO::crc32(schema.data(), schema.size()));
+    BinaryIO::appendUint32(header, BinaryIO::crc32(dir.data(), dir.size()));
+    BinaryIO::appendUint64(header, table.getLogSequence());
+    header.resize(HEADER_SIZE - 4, '\0');
+    BinaryIO::appendUint32(header, BinaryIO::crc32(header.data(), header.size()));
+    out.seekp(0);
+    out.write(header.data(), header.size());
+
+    out.close();
+    if (!out || !FileSync::syncFile(tempPath)) {
+        remove(tempPath.c_str());
+        throw runtime_error("Cannot write table file: " + tempPath);
+    }
+    error_code ec;
+    filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        remove(tempPath.c_str());
+        throw runtime_error("Cannot replace table file " + path + ": " + ec.message());
+    }
+    string parent = filesystem::path(path).parent_path().string();
+    FileSync::syncDirectory(parent.empty() ? "." : parent);
+}
+
+void TableFile::corrupt(const string& what) const {
+    throw runtime_error("Corrupt table file " + path + ": " + what);
+}
+
+void TableFile::readAt(uint64_t offset, size_t size, string& out, const char* what) {
+    out.resize(size);
+    if (size == 0) return;
+    if (mapping) {
+        if (offset + size > mapping->size()) corrupt(string("truncated ") + what);
+        memcpy(&out[0], mapping->data() + offset, size);
+        return;
+    }
+    in.seekg(offset);
+    if (!in.read(&out[0], size)) corrupt(string("truncated ") + what);
+}
+
+TableFile::TableFile(const string& p, bool mapped)
+    : path(p), rowCount(0), rowsPerPage(0), pageCount(0), logSequence(0) {
+    uint64_t fileSize;
+    if (mapped) {
+        mapping.reset(new MappedFile(path));
+        fileSize = mapping->size();
+    } else {
+        in.open(path, ios::binary);
+        if (!in) {
+            throw runtime_error("Cannot open table file: " + path);
+        }
+        in.seekg(0, ios::end);
+        fileSize = static_cast<uint64_t>(in.tellg());
+    }
+
+    string header;
+    if (fileSize < HEADER_SIZE) corrupt("not a table file");
+    readAt(0, HEADER_SIZE, header, "header");
+    if (memcmp(header.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        corrupt("not a table file");
+    }
+    if (BinaryIO::crc32(header.data(), HEADER_SIZE - 4) != BinaryIO::loadUint32(&header[60])) {
+        corrupt("header checksum mismatch");
+    }
+    if (BinaryIO::loadUint32(&header[8]) != VERSION) {
+        corrupt("unsupported version " + to_string(BinaryIO::loadUint32(&header[8])));
+    }
+    size_t columnCount = BinaryIO::loadUint32(&header[12]);
+    rowCount = BinaryIO::loadUint64(&header[16]);
+    rowsPerPage = BinaryIO::loadUint32(&header[24]);
+    size_t schemaLength = BinaryIO::loadUint32(&header[28]);
+    uint64_t directoryOffset = BinaryIO::loadUint64(&header[32]);
+    uint32_t schemaCrc = BinaryIO::loadUint32(&header[40]);
+    uint32_t directoryCrc = BinaryIO::loadUint32(&header[44]);
+    logSequence = BinaryIO::loadUint64(&header[48]);
+    if (rowsPerPage == 0 || HEADER_SIZE + schemaLength > fileSize || directoryOffset > fileSize) {
+        corrupt("bad header");
+    }
+    pageCount = (rowCount + rowsPerPage - 1) / rowsPerPage;
+
+    string schema;
+    readAt(HEADER_SIZE, schemaLength, schema, "schema");
+    if (BinaryIO::crc32(schema.data(), schema.size()) != schemaCrc) corrupt("schema checksum mismatch");
+
+    size_t pos = 0;
+    auto readString = [&](string& s) {
+        if (pos + 4 > schema.size()) corrupt("bad schema");
+        size_t size = BinaryIO::loadUint32(schema.data() + pos);
+        pos += 4;
+        if (pos + size > schema.size()) corrupt("bad schema");
+        s.assign(schema, pos, size);
+        pos += size;
+    };
+    columns.resize(columnCount);
+    for (auto& col : columns) {
+        readString(col.name);
+        if (pos + 4 > schema.size() || static_cast<unsigned char>(schema[pos]) > static_cast<unsigned char>(DataType::UNKNOWN)) {
+            corrupt("bad schema");
+        }
+        col.type = static_cast<DataType>(schema[pos]);
+        col.isPrimaryKey = schema[pos + 1] != 0;
+        col.isUnique = schema[pos + 2] != 0;
+        col.isForeignKey = schema[pos + 3] != 0;
+        pos += 4;
+        readString(col.foreignTable);
+        readString(col.foreignColumn);
+    }
+
+    uint64_t directorySize = static_cast<uint64_t>(columnCount) * pageCount * DIRECTORY_ENTRY_SIZE;
+    if (directoryOffset + directorySize > fileSize) corrupt("truncated page directory");
+    string dir;
+    readAt(directoryOffset, directorySize, dir, "page directory");
+    if (BinaryIO::crc32(dir.data(), dir.size()) != directoryCrc) corrupt("page directory checksum mismatch");
+
+    directory.resize(columnCount * pageCount);
+    for (size_t i = 0; i < directory.size(); ++i) {
+        const char* entry = dir.data() + i * DIRECTORY_ENTRY_SIZE;
+        directory[i].offset = BinaryIO::loadUint64(entry);
+        directory[i].length = BinaryIO::loadUint32(entry + 8);
+        directory[i].crc = BinaryIO::loadUint32(entry + 12);
+        if (directory[i].offset + directory[i].length > directoryOffset) corrupt("bad page directory");
+    }
+
+    if (mapping) {
+        views.resize(directory.size());
+        viewReady.reset(new atomic<bool>[directory.size()]);
+        for (size_t i = 0; i < directory.size(); ++i) viewReady[i].store(false);
+    }
+}
+
+TableFile::PageView TableFile::parsePage(size_t col, size_t page, const char* data, size_t size) const {
+    if (BinaryIO::crc32(data, size) != directory[col * pageCount + page].crc) {
+        corrupt("checksum mismatch in page " + to_string(page) + " of column " + columns[col].name);
+    }
+    size_t n = min(rowsPerPage, rowCount - page * rowsPerPage);
+    if (size < PAGE_HEADER_SIZE || BinaryIO::loadUint32(data) != n) {
+        corrupt("bad page header");
+    }
+
+    PageView view;
+    if (static_cast<PageEncoding>(data[4]) == PageEncoding::GENERIC) {
+        view.generic = true;
+        istringstream generic(string(data + PAGE_HEADER_SIZE, size - PAGE_HEADER_SIZE));
+        view.values.resize(n);
+        for (auto& v : view.values) {
+            if (!BinaryIO::readValue(generic, v)) corrupt("bad page");
+        }
+        return view;
+    }
+    if (static_cast<PageEncoding>(data[4]) != PageEncoding::TYPED) corrupt("unknown page encoding");
+
+    size_t nullBytes = (n + 63) / 64 * 8;
+    if (PAGE_HEADER_SIZE + nullBytes > size) corrupt("bad page");
+    view.nulls = data + PAGE_HEADER_SIZE;
+    view.payload = view.nulls + nullBytes;
+    size_t payloadSize = size - PAGE_HEADER_SIZE - nullBytes;
+
+    switch (physicalTypeOf(columns[col].type)) {
+        case PhysicalType::INT64:
+        case PhysicalType::DOUBLE:
+            if (payloadSize < n * 8) corrupt("bad page");
+            break;
+        case PhysicalType::BOOL:
+            if (payloadSize < n) corrupt("bad page");
+            break;
+        case PhysicalType::TEXT: {
+            size_t offsetsSize = (n + 1) * 4;
+            if (payloadSize < offsetsSize) corrupt("bad page");
+            view.heap = view.payload + offsetsSize;
+            // Offsets must be ascending and end inside the heap
+            uint32_t previous = 0;
+            for (size_t i = 0; i <= n; ++i) {
+                uint32_t offset = BinaryIO::loadUint32(view.payload + i * 4);
+                if (offset < previous) corrupt("bad string offsets");
+                previous = offset;
+            }
+            if (previous > payloadSize - offsetsSize) corrupt("bad string offsets");
+            break;
+        }
+    }
+    return view;
+}
+
+Value TableFile::valueAt(const PageView& view, size_t col, size_t i) const {
+    if (view.generic) return view.values[i];
+    DataType type = columns[col].type;
+    if ((BinaryIO::loadUint64(view.nulls + (i >> 6) * 8) >> (i & 63)) & 1) {
+        return Value::createNull(type);
+    }
+    switch (physicalTypeOf(type)) {
+        case PhysicalType::INT64:
+            return Value::fromInt(static_cast<int64_t>(BinaryIO::loadUint64(view.payload + i * 8)));
+        case PhysicalType::DOUBLE: {
+            uint64_t bits = BinaryIO::loadUint64(view.payload + i * 8);
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            return Value::fromFloat(d);
+        }
+        case PhysicalType::BOOL:
+            return Value::fromBool(view.payload[i] != 0);
+        case PhysicalType::TEXT:
+        default: {
+            uint32_t begin = BinaryIO::loadUint32(view.payload + i * 4);
+            uint32_t end = BinaryIO::loadUint32(view.payload + (i + 1) * 4);
+            Value v;
+            v.type = type;
+            v.data.assign(view.heap + begin, end - begin);
+            return v;
+        }
+    }
+}
+
+const TableFile::PageView& TableFile::mappedPage(size_t col, size_t page) const {
+    size_t i = col * pageCount + page;
+    if (!viewReady[i].load(memory_order_acquire)) {
+        // Threads touching a new page at once may each validate it; the
+        // first to finish publishes its view
+        const PageEntry& entry = directory[i];
+        PageView view = parsePage(col, page, mapping->data() + entry.offset, entry.length);
+        lock_guard<mutex> lock(viewMutex);
+        if (!viewReady[i].load(memory_order_relaxed)) {
+            views[i] = move(view);
+            viewReady[i].store(true, memory_order_release);
+        }
+    }
+    return views[i];
+}
+
+Value TableFile::getValue(size_t row, size_t col) const {
+    return valueAt(mappedPage(col, row / rowsPerPage), col, row % rowsPerPage);
+}
+
+Row TableFile::getRow(size_t row) const {
+    Row r;
+    r.values.reserve(columns.size());
+    for (size_t col = 0; col < columns.size(); ++col) r.values.push_back(getValue(row, col));
+    return r;
+}
+
+bool TableFile::slice(size_t col, size_t row, size_t count, ColumnSlice& out) const {
+    static const uint16_t endianProbe = 1;
+    if (!mapping || *reinterpret_cast<const uint8_t*>(&endianProbe) != 1) return false;
+
+    DataType type = columns[col].type;
+    PhysicalType physical = physicalTypeOf(type);
+    size_t page = row / rowsPerPage;
+    size_t first = row % rowsPerPage;
+    if ((physical != PhysicalType::INT64 && physical != PhysicalType::DOUBLE) || first + count > rowsPerPage) {
+        return false;
+    }
+    const PageView& view = mappedPage(col, page);
+    if (view.generic) return false;
+
+    // Pages start 8-byte aligned in the file and the bitmap is whole words,
+    // so the payload is a properly aligned native array
+    out.type = type;
+    out.ints = physical == PhysicalType::INT64 ? reinterpret_cast<const int64_t*>(view.payload) + first : nullptr;
+    out.floats = physical == PhysicalType::DOUBLE ? reinterpret_cast<const double*>(view.payload) + first : nullptr;
+    out.nullBits = reinterpret_cast<const uint64_t*>(view.nulls);
+    out.nullOffset = first;
+    return true;
+}
+
+void TableFile::readRows(const function<void(Row&&)>& consumer) {
+    // Pages are read in file order, then a wave of page groups (every column
+    // of one row range) is checksummed and decoded on the thread pool
+    ThreadPool& pool = ThreadPool::instance();
+    size_t waveSize = pool.getDegreeOfParallelism();
+    vector<vector<string>> pages(waveSize, vector<string>(columns.size()));
+    vector<vector<Row>> rows(waveSize);
+
+    for (size_t first = 0; first < pageCount; first += waveSize) {
+        size_t count = min(waveSize, pageCount - first);
+        for (size_t w = 0; w < count; ++w) {
+            for (size_t col = 0; col < columns.size(); ++col) {
+                const PageEntry& entry = directory[col * pageCount + first + w];
+                readAt(entry.offset, entry.length, pages[w][col], "page");
+            }
+        }
+        pool.parallelFor(count, [&](size_t w) {
+            size_t page = first + w;
+            size_t n = min(rowsPerPage, rowCount - page * rowsPerPage);
+            rows[w].assign(n, Row());
+            for (auto& row : rows[w]) row.values.reserve(columns.size());
+            for (size_t col = 0; col < columns.size(); ++col) {
+                const string& bytes = pages[w][col];
+                PageView view = parsePage(col, page, bytes.data(), bytes.size());
+                for (size_t i = 0; i < n; ++i) {
+                    if (view.generic) {
+                        rows[w][i].values.push_back(move(view.values[i]));
+                    } else {
+                        rows[w][i].values.push_back(valueAt(view, col, i));
+                    }
+                }
+            }
+        });
+        for (size_t w = 0; w < count; ++w) {
+            for (auto& row : rows[w]) consumer(move(row));
+        }
+    }
+}
@@ -0,0 +1,109 @@
+// include/TableFile.h
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <functional>
+#include <cstdint>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include "Column.h"
+#include "Row.h"
+#include "ColumnStore.h"
+#include "MappedFile.h"
+
+using namespace std;
+
+class Table;
+
+// Native on-disk table format (.tbl). All integers are little-endian.
+//
+//   header     64 bytes: magic, version, column/row counts, rows per page,
+//              schema length, directory offset, schema/directory CRCs, the
+//              LSN of the last write-ahead log record reflected, header CRC
+//   schema     per column: name, type, PK/UNIQUE/FK flags, FK target
+//   pages      one column of up to ROWS_PER_PAGE rows each, 8-byte aligned
+//   directory  per column, per page: offset, length, CRC-32
+//
+// A typed page is an 8-byte page header (row count, encoding), the NULL
+// bitmap in 64-bit words, then the column's physical payload: 8 bytes per
+// INTEGER/FLOAT row, 1 byte per BOOLEAN row, or for text columns n+1 offsets
+// into the page's string heap followed by the heap bytes. A page holding a
+// value that does not fit the column type (e.g. text kept in an INT column)
+// is written with the generic encoding: one BinaryIO value per row.
+class TableFile {
+public:
+    static const uint32_t VERSION = 1;
+    static constexpr size_t ROWS_PER_PAGE = 4096;
+
+    // Replaces the file at 'path' atomically (synced temp file + rename);
+    // throws runtime_error if it cannot be written. 'throttle', if set, is
+    // called with the size of each page written and may sleep to limit the
+    // write rate.
+    static void write(const string& path, const Table& table,
+                      const function<void(size_t)>& throttle = nullptr);
+
+    // Opens the file and validates the header, schema and page directory;
+    // throws runtime_error if it is missing or corrupt. A mapped file is
+    // memory-mapped and read in place: a page is only faulted in (and its
+    // checksum verified) when a row on it is first accessed.
+    explicit TableFile(const string& path, bool mapped = false);
+
+    const string& getPath() const { return path; }
+    const vector<Column>& getColumns() const { return columns; }
+    size_t getRowCount() const { return rowCount; }
+    uint64_t getLogSequence() const { return logSequence; }
+
+    // Decodes every row in order, verifying page checksums on the way
+    void readRows(const function<void(Row&&)>& consumer);
+
+    // Random access to a mapped file; throw runtime_error on a corrupt page
+    Value getValue(size_t row, size_t col) const;
+    Row getRow(size_t row) const;
+
+    // Points 'out' at rows [row, row + count) of an INTEGER or FLOAT column
+    // when they sit on one typed page and can be used as a native array in
+    // place (mapped file, little-endian host); false otherwise
+    bool slice(size_t col, size_t row, size_t count, ColumnSlice& out) const;
+
+private:
+    struct PageEntry {
+        uint64_t offset;
+        uint32_t length;
+        uint32_t crc;
+    };
+
+    // A validated page: pointers into its bytes, or the decoded values of a
+    // generic page
+    struct PageView {
+        bool generic;
+        const char* nulls;      // NULL bitmap words
+        const char* payload;    // Fixed-width values, or text offsets
+        const char* heap;       // Text bytes
+        vector<Value> values;
+
+        PageView() : generic(false), nulls(nullptr), payload(nullptr), heap(nullptr) {}
+    };
+
+    string path;
+    ifstream in;
+    unique_ptr<MappedFile> mapping;
+    vector<Column> columns;
+    size_t rowCount;
+    size_t rowsPerPage;
+    size_t pageCount;
+    uint64_t logSequence;
+    vector<PageEntry> directory;    // Column-major: directory[col * pageCount + page]
+
+    // Mapped files: pages validated on first access
+    mutable vector<PageView> views;
+    mutable unique_ptr<atomic<bool>[]> viewReady;
+    mutable mutex viewMutex;
+
+    [[noreturn]] void corrupt(const string& what) const;
+    void readAt(uint64_t offset, size_t size, string& out, const char* what);
+    PageView parsePage(size_t col, size_t page, const char* data, size_t size) const;
+    const PageView& mappedPage(size_t col, size_t page) const;
+    Value valueAt(const PageView& view, size_t col, size_t i) const;
+};
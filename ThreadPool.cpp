@@ -0,0 +1,154 @@
+// src/ThreadPool.cpp
+#include "ThreadPool.h"
+#include <chrono>
+
+using namespace std;
+
+ThreadPool& ThreadPool::instance() {
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::ThreadPool() : queuedTasks(0), nextQueue(0), stopping(false) {
+    setDegreeOfParallelism(0);
+}
+
+ThreadPool::~ThreadPool() {
+    stopWorkers();
+}
+
+void ThreadPool::setDegreeOfParallelism(size_t threads) {
+    if (threads == 0) {
+        threads = thread::hardware_concurrency();
+        if (threads == 0) threads = 1;
+    }
+    stopWorkers();
+    startWorkers(threads - 1); // The calling thread is the remaining one
+}
+
+void ThreadPool::startWorkers(size_t count) {
+    stopping = false;
+    queues.clear();
+    for (size_t i = 0; i < count; ++i) {
+        queues.push_back(make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < count; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+void ThreadPool::stopWorkers() {
+    {
+        lock_guard<mutex> lk(sleepMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+void ThreadPool::runTask(const Task& task) {
+    Batch* batch = task.batch;
+    try {
+        (*batch->fn)(task.index);
+    } catch (...) {
+        lock_guard<mutex> lk(batch->doneMutex);
+        if (!batch->firstError) batch->firstError = current_exception();
+    }
+    // Decrement under the lock so the waiting thread cannot return (and
+    // destroy the batch) while this thread still uses it
+    lock_guard<mutex> lk(batch->doneMutex);
+    if (batch->remaining.fetch_sub(1) == 1) {
+        batch->done.notify_all();
+    }
+}
+
+bool ThreadPool::tryRunTask(size_t self) {
+    if (queuedTasks.load() == 0) return false;
+
+    Task task{nullptr, 0};
+    // Own queue first (newest task, still warm in cache)
+    if (self < queues.size()) {
+        WorkerQueue& own = *queues[self];
+        lock_guard<mutex> lk(own.lock);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+        }
+    }
+    // Otherwise steal the oldest task of another queue
+    for (size_t i = 0; !task.batch && i < queues.size(); ++i) {
+        size_t victim = (self + 1 + i) % queues.size();
+        if (victim == self) continue;
+        WorkerQueue& other = *queues[victim];
+        lock_guard<mutex> lk(other.lock);
+        if (!other.tasks.empty()) {
+            task = other.tasks.front();
+            other.tasks.pop_front();
+        }
+    }
+    if (!task.batch) return false;
+
+    queuedTasks.fetch_sub(1);
+    runTask(task);
+    return true;
+}
+
+void ThreadPool::workerLoop(size_t self) {
+    while (true) {
+        if (tryRunTask(self)) continue;
+
+        unique_lock<mutex> lk(sleepMutex);
+        wakeUp.wait(lk, [&] { return stopping || queuedTasks.load() > 0; });
+        if (stopping && queuedTasks.load() == 0) return;
+    }
+}
+
+void ThreadPool::parallelFor(size_t taskCount, const function<void(size_t)>& fn) {
+    if (taskCount == 0) return;
+    if (workers.empty() || taskCount == 1) {
+        for (size_t i = 0; i < taskCount; ++i) fn(i);
+        return;
+    }
+
+    Batch batch;
+    batch.fn = &fn;
+    batch.remaining = taskCount;
+
+    // Deal the tasks out round-robin over the worker queues
+    size_t start = nextQueue.fetch_add(1);
+    for (size_t i = 0; i < taskCount; ++i) {
+        WorkerQueue& queue = *queues[(start + i) % queues.size()];
+        lock_guard<mutex> lk(queue.lock);
+        queue.tasks.push_back(Task{&batch, i});
+    }
+    queuedTasks.fetch_add(taskCount);
+    {
+        lock_guard<mutex> lk(sleepMutex);
+    }
+    wakeUp.notify_all();
+
+    // Help out until every task of this batch has finished
+    size_t self = queues.size();
+    while (batch.remaining.load() > 0) {
+        if (tryRunTask(self)) continue;
+        unique_lock<mutex> lk(batch.doneMutex);
+        batch.done.wait_for(lk, chrono::milliseconds(1), [&] { return batch.remaining.load() == 0; });
+    }
+
+    // Taking the lock orders this after the last task's notify
+    lock_guard<mutex> lk(batch.doneMutex);
+    if (batch.firstError) rethrow_exception(batch.firstError);
+}
+
+void parallelForRange(size_t count, size_t grain, const function<void(size_t, size_t)>& fn) {
+    if (grain == 0) grain = 1;
+    size_t morsels = (count + grain - 1) / grain;
+    ThreadPool::instance().parallelFor(morsels, [&](size_t m) {
+        size_t begin = m * grain;
+        size_t end = begin + grain < count ? begin + grain : count;
+        fn(begin, end);
+    });
+}
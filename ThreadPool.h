@@ -0,0 +1,78 @@
+// include/ThreadPool.h
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <exception>
+
+using namespace std;
+
+// Engine-wide pool of worker threads. Each worker owns a task deque; it runs
+// its own tasks newest-first and, when idle, steals the oldest task from
+// another worker. A thread waiting in parallelFor runs queued tasks too, so
+// parallel sections may nest without deadlocking.
+class ThreadPool {
+public:
+    static ThreadPool& instance();
+
+    // Number of threads (including the caller) used by parallelFor.
+    // 0 selects the hardware concurrency; 1 runs everything on the caller.
+    // Only change this while no parallel work is running.
+    void setDegreeOfParallelism(size_t threads);
+    size_t getDegreeOfParallelism() const { return workers.size() + 1; }
+
+    // Runs fn(i) for every i in [0, taskCount) and returns when all are done.
+    // The first exception thrown by a task is rethrown here.
+    void parallelFor(size_t taskCount, const function<void(size_t)>& fn);
+
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+private:
+    // One parallelFor call
+    struct Batch {
+        const function<void(size_t)>* fn;
+        atomic<size_t> remaining;
+        mutex doneMutex;
+        condition_variable done;
+        exception_ptr firstError;
+    };
+
+    struct Task {
+        Batch* batch;
+        size_t index;
+    };
+
+    struct WorkerQueue {
+        mutex lock;
+        deque<Task> tasks;
+    };
+
+    vector<thread> workers;
+    vector<unique_ptr<WorkerQueue>> queues; // One per worker
+    atomic<size_t> queuedTasks;
+    atomic<size_t> nextQueue;               // Round-robin start for task distribution
+    mutex sleepMutex;
+    condition_variable wakeUp;
+    bool stopping;
+
+    ThreadPool();
+    void startWorkers(size_t count);
+    void stopWorkers();
+    void workerLoop(size_t self);
+    bool tryRunTask(size_t self);           // self == queues.size() for a non-worker thread
+    static void runTask(const Task& task);
+};
+
+// Rows handed to one task by parallel scans
+const size_t MORSEL_SIZE = 16384;
+
+// Splits [0, count) into morsels of about 'grain' items and runs
+// fn(begin, end) for each on the thread pool
+void parallelForRange(size_t count, size_t grain, const function<void(size_t, size_t)>& fn);
@@ -1,6 +1,10 @@
 // include/Value.h
 #pragma once
 #include <string>
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+#include <functional>
 
 using namespace std;
 
@@ -17,12 +21,31 @@ enum class DataType {
 class Value {
 public:
     DataType type;
-    string data;
+    string data;      // Payload for text types (STRING, VARCHAR, DATE, UNKNOWN)
     bool isNull;
 
-    Value() : type(DataType::UNKNOWN), isNull(false) {}
-    Value(DataType t, const string& d) : type(t), data(d), isNull(d == "null" || d == "NULL") {}
-    
+    // Decoded payload for non-text types, selected by 'type'
+    union {
+        int64_t intValue;   // INTEGER
+        double floatValue;  // FLOAT
+        bool boolValue;     // BOOLEAN
+    };
+
+    Value() : type(DataType::UNKNOWN), isNull(false), intValue(0) {}
+
+    // Parse the textual form once; if the text does not fit the requested type
+    // the value is kept as a STRING so nothing is lost
+    Value(DataType t, const string& d) : type(t), isNull(d == "null" || d == "NULL"), intValue(0) {
+        if (isNull) {
+            data = "null";
+            return;
+        }
+        if (!parsePayload(t, d)) {
+            type = DataType::STRING;
+            data = d;
+        }
+    }
+
     // Static factory method for NULL values
     static Value createNull(DataType t = DataType::UNKNOWN) {
         Value v;
@@ -32,78 +55,270 @@ public:
         return v;
     }
 
+    static Value fromInt(int64_t i) {
+        Value v;
+        v.type = DataType::INTEGER;
+        v.intValue = i;
+        return v;
+    }
+
+    static Value fromFloat(double f) {
+        Value v;
+        v.type = DataType::FLOAT;
+        v.floatValue = f;
+        return v;
+    }
+
+    static Value fromBool(bool b) {
+        Value v;
+        v.type = DataType::BOOLEAN;
+        v.boolValue = b;
+        return v;
+    }
+
+    static bool isNumericType(DataType t) {
+        return t == DataType::INTEGER || t == DataType::FLOAT || t == DataType::BOOLEAN;
+    }
+
+    bool isNumeric() const { return isNumericType(type); }
+
+    // Numeric payload as double (only meaningful when isNumeric())
+    double asDouble() const {
+        switch (type) {
+            case DataType::INTEGER: return static_cast<double>(intValue);
+            case DataType::FLOAT: return floatValue;
+            case DataType::BOOLEAN: return boolValue ? 1.0 : 0.0;
+            default: return 0.0;
+        }
+    }
+
+    // Numeric view of the value; text is parsed, NULL and non-numeric text fail
+    bool tryGetDouble(double& out) const {
+        if (isNull) return false;
+        if (isNumeric()) {
+            out = asDouble();
+            return true;
+        }
+        return parseDouble(data, out);
+    }
+
+    // Textual form used for display and CSV persistence
+    string toString() const {
+        if (isNull) return "null";
+        switch (type) {
+            case DataType::INTEGER: return to_string(intValue);
+            case DataType::FLOAT: {
+                // Shortest round-trip digits; plain notation unless the
+                // magnitude is very large or very small
+                char buf[64];
+                double mag = floatValue < 0 ? -floatValue : floatValue;
+                bool plain = mag == 0 || (mag >= 1e-5 && mag < 1e16);
+                auto res = plain ? to_chars(buf, buf + sizeof(buf), floatValue, chars_format::fixed)
+                                 : to_chars(buf, buf + sizeof(buf), floatValue);
+                return string(buf, res.ptr);
+            }
+            case DataType::BOOLEAN: return boolValue ? "true" : "false";
+            default: return data;
+        }
+    }
+
+    // Three-way comparison of two non-NULL values, dispatching on DataType.
+    // Numbers compare numerically, text compares lexicographically; when a number
+    // meets text, the text is compared numerically if it parses as a number.
+    int compare(const Value& other) const {
+        bool thisNumeric = isNumeric();
+        bool otherNumeric = other.isNumeric();
+        if (thisNumeric && otherNumeric) {
+            if (type == DataType::INTEGER && other.type == DataType::INTEGER) {
+                return intValue < other.intValue ? -1 : (intValue > other.intValue ? 1 : 0);
+            }
+            double a = asDouble();
+            double b = other.asDouble();
+            return a < b ? -1 : (a > b ? 1 : 0);
+        }
+        if (!thisNumeric && !otherNumeric) {
+            int c = data.compare(other.data);
+            return c < 0 ? -1 : (c > 0 ? 1 : 0);
+        }
+        double a, b;
+        if (tryGetDouble(a) && other.tryGetDouble(b)) {
+            return a < b ? -1 : (a > b ? 1 : 0);
+        }
+        int c = toString().compare(other.toString());
+        return c < 0 ? -1 : (c > 0 ? 1 : 0);
+    }
+
     bool operator==(const Value& other) const {
         // NULL comparisons: NULL == NULL is false in SQL
         if (isNull || other.isNull) return false;
-        return data == other.data;
+        return compare(other) == 0;
     }
 
     bool operator!=(const Value& other) const {
         // NULL comparisons: NULL != value is false in SQL
         if (isNull || other.isNull) return false;
-        return data != other.data;
+        return compare(other) != 0;
     }
 
     bool operator<(const Value& other) const {
         // NULL comparisons: NULL < value is false in SQL
         if (isNull || other.isNull) return false;
-        try {
-            double thisNum = stod(data);
-            double otherNum = stod(other.data);
-            return thisNum < otherNum;
-        } catch (...) {
-            return data < other.data;
-        }
+        return compare(other) < 0;
     }
 
     bool operator>(const Value& other) const {
         // NULL comparisons: NULL > value is false in SQL
         if (isNull || other.isNull) return false;
-        // Try numeric comparison first
-        try {
-            double thisNum = stod(data);
-            double otherNum = stod(other.data);
-            return thisNum > otherNum;
-        } catch (...) {
-            // Fall back to string comparison
-            return data > other.data;
-        }
+        return compare(other) > 0;
     }
-    
-    // Validate if value can be converted to the specified type
-    bool isValidForType(DataType targetType) const {
-        if (isNull) return true; // NULL is valid for any type
-        
+
+    // Convert to the target type; returns false if the value does not fit
+    bool tryConvert(DataType targetType, Value& out) const {
+        if (isNull) {
+            out = createNull(targetType);
+            return true;
+        }
+        if (type == targetType) {
+            out = *this;
+            return true;
+        }
+
         switch (targetType) {
             case DataType::INTEGER:
-                try {
-                    size_t pos;
-                    stoi(data, &pos);
-                    return pos == data.length(); // Ensure entire string was converted
-                } catch (...) {
-                    return false;
+                if (type == DataType::BOOLEAN) {
+                    out = fromInt(boolValue ? 1 : 0);
+                    return true;
                 }
-            
+                if (isNumeric()) return false; // FLOAT does not narrow to INTEGER
+                break;
+
             case DataType::FLOAT:
-                try {
-                    size_t pos;
-                    stod(data, &pos);
-                    return pos == data.length();
-                } catch (...) {
-                    return false;
+                if (isNumeric()) {
+                    out = fromFloat(asDouble());
+                    return true;
                 }
-            
+                break;
+
             case DataType::BOOLEAN:
-                return data == "0" || data == "1" || 
-                       data == "true" || data == "false" ||
-                       data == "TRUE" || data == "FALSE";
-            
+                if (type == DataType::INTEGER) {
+                    if (intValue != 0 && intValue != 1) return false;
+                    out = fromBool(intValue == 1);
+                    return true;
+                }
+                if (isNumeric()) return false;
+                break;
+
             case DataType::STRING:
             case DataType::VARCHAR:
             case DataType::DATE:
             case DataType::UNKNOWN:
             default:
+                out = Value();
+                out.type = targetType;
+                out.data = toString();
                 return true; // Strings accept anything
         }
+
+        // Text source: parse it into the target type
+        Value parsed;
+        parsed.type = targetType;
+        if (!parsed.parsePayload(targetType, data)) return false;
+        out = parsed;
+        return true;
+    }
+
+    // Converted copy, or an unchanged copy if the value does not fit the type
+    Value convertTo(DataType targetType) const {
+        Value out;
+        if (tryConvert(targetType, out)) return out;
+        return *this;
+    }
+
+    // Validate if value can be converted to the specified type
+    bool isValidForType(DataType targetType) const {
+        if (isNull) return true; // NULL is valid for any type
+        Value converted;
+        return tryConvert(targetType, converted);
+    }
+
+    // Hash consistent with ValueEqual: numbers hash by numeric value, text by content
+    size_t hash() const {
+        if (isNull) return 0x9e3779b97f4a7c15ULL;
+        switch (type) {
+            case DataType::INTEGER: return std::hash<int64_t>()(intValue);
+            case DataType::BOOLEAN: return std::hash<int64_t>()(boolValue ? 1 : 0);
+            case DataType::FLOAT: {
+                double f = floatValue;
+                if (f >= -9.2e18 && f <= 9.2e18 && f == static_cast<double>(static_cast<int64_t>(f))) {
+                    return std::hash<int64_t>()(static_cast<int64_t>(f));
+                }
+                return std::hash<double>()(f);
+            }
+            default: return std::hash<string>()(data);
+        }
+    }
+
+    static bool parseDouble(const string& s, double& out) {
+        if (s.empty()) return false;
+        const char* begin = s.data();
+        const char* end = begin + s.size();
+        if (*begin == '+') ++begin;
+        auto res = from_chars(begin, end, out);
+        return res.ec == errc() && res.ptr == end;
+    }
+
+    static bool parseInt(const string& s, int64_t& out) {
+        if (s.empty()) return false;
+        const char* begin = s.data();
+        const char* end = begin + s.size();
+        if (*begin == '+') ++begin;
+        auto res = from_chars(begin, end, out);
+        return res.ec == errc() && res.ptr == end;
+    }
+
+private:
+    // Decode text into the payload for type t; text types keep the string as-is
+    bool parsePayload(DataType t, const string& d) {
+        switch (t) {
+            case DataType::INTEGER:
+                return parseInt(d, intValue);
+
+            case DataType::FLOAT:
+                return parseDouble(d, floatValue);
+
+            case DataType::BOOLEAN:
+                if (d == "1" || d == "true" || d == "TRUE") {
+                    boolValue = true;
+                    return true;
+                }
+                if (d == "0" || d == "false" || d == "FALSE") {
+                    boolValue = false;
+                    return true;
+                }
+                return false;
+
+            case DataType::STRING:
+            case DataType::VARCHAR:
+            case DataType::DATE:
+            case DataType::UNKNOWN:
+            default:
+                data = d;
+                return true;
+        }
+    }
+};
+
+// Hash/equality functors for typed keys in hash tables. Unlike operator==,
+// NULL keys are equal to each other so they can be grouped, and values of
+// different type classes (number vs text) never collide.
+struct ValueHash {
+    size_t operator()(const Value& v) const { return v.hash(); }
+};
+
+struct ValueEqual {
+    bool operator()(const Value& a, const Value& b) const {
+        if (a.isNull || b.isNull) return a.isNull && b.isNull;
+        if (a.isNumeric() != b.isNumeric()) return false;
+        return a.compare(b) == 0;
     }
 };
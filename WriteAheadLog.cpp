@@ -0,0 +1,348 @@
+// src/WriteAheadLog.cpp
+#include "WriteAheadLog.h"
+#include "BinaryIO.h"
+#include "FileSync.h"
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <filesystem>
+#include <stdexcept>
+#include <cstring>
+
+using namespace std;
+
+static const char MAGIC[8] = {'D', 'B', 'W', 'A', 'L', '\0', '\0', '\0'};
+static const size_t HEADER_SIZE = 16;
+static const size_t RECORD_HEADER_SIZE = 8;
+
+static string parentDirectory(const string& path) {
+    string parent = filesystem::path(path).parent_path().string();
+    return parent.empty() ? "." : parent;
+}
+
+WriteAheadLog::WriteAheadLog(const string& p)
+    : path(p), file(nullptr), unsynced(false), fileSize(0), nextSequence(1), groupCommitBytes(1 << 20) {
+    string contents;
+    {
+        ifstream in(path, ios::binary);
+        if (in) contents.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+    // A log shorter than its header was being created or reset, and so held
+    // no records yet
+    if (contents.size() < HEADER_SIZE) {
+        create();
+        return;
+    }
+    if (memcmp(contents.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        throw runtime_error("Not a write-ahead log: " + path);
+    }
+    if (BinaryIO::loadUint32(&contents[8]) != VERSION) {
+        throw runtime_error("Unsupported write-ahead log version in " + path);
+    }
+
+    // Keep records up to the first one that is incomplete or fails its checksum
+    size_t pos = HEADER_SIZE;
+    while (pos + RECORD_HEADER_SIZE <= contents.size()) {
+        size_t length = BinaryIO::loadUint32(&contents[pos]);
+        uint32_t crc = BinaryIO::loadUint32(&contents[pos + 4]);
+        const char* body = contents.data() + pos + RECORD_HEADER_SIZE;
+        if (length < 9 || pos + RECORD_HEADER_SIZE + length > contents.size()) break;
+        if (BinaryIO::crc32(body, length) != crc) break;
+        uint64_t sequence = BinaryIO::loadUint64(body);
+        if (sequence < nextSequence) break;
+        nextSequence = sequence + 1;
+        pos += RECORD_HEADER_SIZE + length;
+    }
+    recovered.assign(contents, HEADER_SIZE, pos - HEADER_SIZE);
+    fileSize = recovered.size();
+
+    if (pos < contents.size()) {
+        error_code ec;
+        filesystem::resize_file(path, pos, ec);
+        if (ec) throw runtime_error("Cannot truncate write-ahead log " + path + ": " + ec.message());
+    }
+    file = fopen(path.c_str(), "ab");
+    if (!file) {
+        throw runtime_error("Cannot open write-ahead log: " + path);
+    }
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    if (!file) return;
+    // Unsynced records still reach the OS; only commit makes them durable
+    if (!pending.empty()) fwrite(pending.data(), 1, pending.size(), file);
+    fclose(file);
+}
+
+void WriteAheadLog::create() {
+    if (file) fclose(file);
+    file = fopen(path.c_str(), "wb");
+    if (!file) {
+        throw runtime_error("Cannot create write-ahead log: " + path);
+    }
+    string header(MAGIC, sizeof(MAGIC));
+    BinaryIO::appendUint32(header, VERSION);
+    header.resize(HEADER_SIZE, '\0');
+    if (fwrite(header.data(), 1, header.size(), file) != header.size() || !FileSync::syncFile(file)) {
+        throw runtime_error("Cannot write write-ahead log: " + path);
+    }
+    FileSync::syncDirectory(parentDirectory(path));
+    fileSize = 0;
+    unsynced = false;
+}
+
+void WriteAheadLog::reopen() {
+    if (file) return;
+    file = fopen(path.c_str(), "ab");
+    if (!file) {
+        throw runtime_error("Cannot open write-ahead log: " + path);
+    }
+    // The rewrite that closed it may or may not have replaced the file
+    error_code ec;
+    uintmax_t size = filesystem::file_size(path, ec);
+    fileSize = !ec && size > HEADER_SIZE ? size - HEADER_SIZE : 0;
+}
+
+void WriteAheadLog::writePending() {
+    if (pending.empty()) return;
+    reopen();
+    if (fwrite(pending.data(), 1, pending.size(), file) != pending.size()) {
+        throw runtime_error("Cannot write write-ahead log: " + path);
+    }
+    fileSize += pending.size();
+    pending.clear();
+    unsynced = true;
+}
+
+void WriteAheadLog::commit() {
+    reopen();
+    writePending();
+    if (!unsynced) return;
+    if (!FileSync::syncFile(file)) {
+        throw runtime_error("Cannot sync write-ahead log: " + path);
+    }
+    unsynced = false;
+}
+
+void WriteAheadLog::reset() {
+    pending.clear();
+    recovered.clear();
+    create();
+}
+
+void WriteAheadLog::discardThrough(uint64_t sequence) {
+    commit();
+    string contents;
+    {
+        ifstream in(path, ios::binary);
+        if (in) contents.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+    // Records are in LSN order: keep the suffix after 'sequence'
+    size_t pos = HEADER_SIZE;
+    while (pos + RECORD_HEADER_SIZE + 8 <= contents.size() &&
+           BinaryIO::loadUint64(&contents[pos + RECORD_HEADER_SIZE]) <= sequence) {
+        pos += RECORD_HEADER_SIZE + BinaryIO::loadUint32(&contents[pos]);
+    }
+    if (pos >= contents.size()) {
+        reset();
+        return;
+    }
+
+    // The kept records go to a synced copy that replaces the log
+    string tempPath = path + ".tmp";
+    FILE* out = fopen(tempPath.c_str(), "wb");
+    bool ok = out != nullptr;
+    if (ok) {
+        ok = fwrite(contents.data(), 1, HEADER_SIZE, out) == HEADER_SIZE &&
+             fwrite(contents.data() + pos, 1, contents.size() - pos, out) == contents.size() - pos &&
+             FileSync::syncFile(out);
+        ok = fclose(out) == 0 && ok;
+    }
+    if (!ok) {
+        remove(tempPath.c_str());
+        throw runtime_error("Cannot write write-ahead log: " + tempPath);
+    }
+    // The open log is closed first: Windows cannot rename over an open file.
+    // If it cannot be reopened, the next write or commit tries again.
+    fclose(file);
+    file = nullptr;
+    error_code ec;
+    filesystem::rename(tempPath, path, ec);
+    file = fopen(path.c_str(), "ab");
+    if (ec || !file) {
+        throw runtime_error("Cannot replace write-ahead log " + path + (ec ? ": " + ec.message() : string()));
+    }
+    FileSync::syncDirectory(parentDirectory(path));
+    fileSize = contents.size() - pos;
+}
+
+uint64_t WriteAheadLog::append(LogRecordType type, const string& table, const string& payload) {
+    uint64_t sequence = nextSequence++;
+    string body;
+    body.reserve(13 + table.size() + payload.size());
+    BinaryIO::appendUint64(body, sequence);
+    body.push_back(static_cast<char>(type));
+    BinaryIO::appendUint32(body, static_cast<uint32_t>(table.size()));
+    body += table;
+    body += payload;
+
+    BinaryIO::appendUint32(pending, static_cast<uint32_t>(body.size()));
+    BinaryIO::appendUint32(pending, BinaryIO::crc32(body.data(), body.size()));
+    pending += body;
+    if (pending.size() >= groupCommitBytes) writePending();
+    return sequence;
+}
+
+uint64_t WriteAheadLog::logCreateTable(const string& table, const vector<Column>& columns, StorageMode mode) {
+    ostringstream payload;
+    payload.put(static_cast<char>(mode));
+    BinaryIO::writeUint32(payload, static_cast<uint32_t>(columns.size()));
+    for (const auto& col : columns) {
+        BinaryIO::writeString(payload, col.name);
+        payload.put(static_cast<char>(col.type));
+        payload.put(col.isPrimaryKey ? 1 : 0);
+        payload.put(col.isUnique ? 1 : 0);
+        payload.put(col.isForeignKey ? 1 : 0);
+        BinaryIO::writeString(payload, col.foreignTable);
+        BinaryIO::writeString(payload, col.foreignColumn);
+    }
+    return append(LogRecordType::CREATE_TABLE, table, payload.str());
+}
+
+uint64_t WriteAheadLog::logDropTable(const string& table) {
+    return append(LogRecordType::DROP_TABLE, table, string());
+}
+
+uint64_t WriteAheadLog::logCreateIndex(const string& table, const string& index, const string& column) {
+    ostringstream payload;
+    BinaryIO::writeString(payload, index);
+    BinaryIO::writeString(payload, column);
+    return append(LogRecordType::CREATE_INDEX, table, payload.str());
+}
+
+uint64_t WriteAheadLog::logDropIndex(const string& table, const string& index) {
+    ostringstream payload;
+    BinaryIO::writeString(payload, index);
+    return append(LogRecordType::DROP_INDEX, table, payload.str());
+}
+
+uint64_t WriteAheadLog::logInsert(const string& table, const Row& row) {
+    ostringstream payload;
+    BinaryIO::writeRow(payload, row);
+    return append(LogRecordType::INSERT, table, payload.str());
+}
+
+uint64_t WriteAheadLog::logUpdate(const string& table, const vector<size_t>& columns,
+                                  const vector<size_t>& rowIds, const vector<Row>& rows) {
+    ostringstream payload;
+    BinaryIO::writeUint32(payload, static_cast<uint32_t>(columns.size()));
+    for (size_t col : columns) BinaryIO::writeUint32(payload, static_cast<uint32_t>(col));
+    BinaryIO::writeUint64(payload, rowIds.size());
+    for (size_t i = 0; i < rowIds.size(); ++i) {
+        BinaryIO::writeUint64(payload, rowIds[i]);
+        for (size_t col : columns) BinaryIO::writeValue(payload, rows[i].values[col]);
+    }
+    return append(LogRecordType::UPDATE, table, payload.str());
+}
+
+uint64_t WriteAheadLog::logDelete(const string& table, const vector<size_t>& rowIds) {
+    string payload;
+    payload.reserve(8 + rowIds.size() * 8);
+    BinaryIO::appendUint64(payload, rowIds.size());
+    for (size_t rowId : rowIds) BinaryIO::appendUint64(payload, rowId);
+    return append(LogRecordType::DELETE, table, payload);
+}
+
+// Parses a record body whose checksum has already been verified
+static bool decodeRecord(const string& body, LogRecord& r) {
+    istringstream in(body);
+    uint64_t count;
+    uint32_t size;
+    if (!BinaryIO::readUint64(in, r.sequence)) return false;
+    int type = in.get();
+    if (type < static_cast<int>(LogRecordType::CREATE_TABLE) || type > static_cast<int>(LogRecordType::DELETE)) {
+        return false;
+    }
+    r.type = static_cast<LogRecordType>(type);
+    if (!BinaryIO::readString(in, r.tableName)) return false;
+
+    switch (r.type) {
+        case LogRecordType::CREATE_TABLE: {
+            int mode = in.get();
+            if (mode < 0 || mode > static_cast<int>(StorageMode::MAPPED)) return false;
+            r.storageMode = static_cast<StorageMode>(mode);
+            if (!BinaryIO::readUint32(in, size)) return false;
+            r.columns.resize(size);
+            for (auto& col : r.columns) {
+                if (!BinaryIO::readString(in, col.name)) return false;
+                int colType = in.get();
+                if (colType < 0 || colType > static_cast<int>(DataType::UNKNOWN)) return false;
+                col.type = static_cast<DataType>(colType);
+                col.isPrimaryKey = in.get() == 1;
+                col.isUnique = in.get() == 1;
+                col.isForeignKey = in.get() == 1;
+                if (!BinaryIO::readString(in, col.foreignTable) || !BinaryIO::readString(in, col.foreignColumn)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case LogRecordType::DROP_TABLE:
+            return true;
+        case LogRecordType::CREATE_INDEX:
+            return BinaryIO::readString(in, r.indexName) && BinaryIO::readString(in, r.columnName);
+        case LogRecordType::DROP_INDEX:
+            return BinaryIO::readString(in, r.indexName);
+        case LogRecordType::INSERT:
+            r.rows.resize(1);
+            return BinaryIO::readRow(in, r.rows[0]);
+        case LogRecordType::UPDATE: {
+            if (!BinaryIO::readUint32(in, size)) return false;
+            r.columnIds.resize(size);
+            for (auto& col : r.columnIds) {
+                uint32_t id;
+                if (!BinaryIO::readUint32(in, id)) return false;
+                col = id;
+            }
+            if (!BinaryIO::readUint64(in, count) || count > body.size()) return false;
+            r.rowIds.resize(count);
+            r.rows.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                uint64_t rowId;
+                if (!BinaryIO::readUint64(in, rowId)) return false;
+                r.rowIds[i] = rowId;
+                r.rows[i].values.resize(r.columnIds.size());
+                for (auto& v : r.rows[i].values) {
+                    if (!BinaryIO::readValue(in, v)) return false;
+                }
+            }
+            return true;
+        }
+        case LogRecordType::DELETE: {
+            if (!BinaryIO::readUint64(in, count) || count > body.size()) return false;
+            r.rowIds.resize(count);
+            for (auto& rowId : r.rowIds) {
+                uint64_t id;
+                if (!BinaryIO::readUint64(in, id)) return false;
+                rowId = id;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void WriteAheadLog::replay(const function<void(const LogRecord&)>& consumer) {
+    size_t pos = 0;
+    while (pos < recovered.size()) {
+        size_t length = BinaryIO::loadUint32(&recovered[pos]);
+        LogRecord record;
+        if (!decodeRecord(recovered.substr(pos + RECORD_HEADER_SIZE, length), record)) {
+            throw runtime_error("Corrupt write-ahead log record " + to_string(record.sequence) + " in " + path);
+        }
+        consumer(record);
+        pos += RECORD_HEADER_SIZE + length;
+    }
+    recovered.clear();
+    recovered.shrink_to_fit();
+}
@@ -0,0 +1,116 @@
+// include/WriteAheadLog.h
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <functional>
+#include "Column.h"
+#include "Row.h"
+#include "ColumnStore.h"
+
+using namespace std;
+
+enum class LogRecordType : uint8_t {
+    CREATE_TABLE = 1,
+    DROP_TABLE,
+    CREATE_INDEX,
+    DROP_INDEX,
+    INSERT,
+    UPDATE,
+    DELETE
+};
+
+// One decoded redo record. Row changes are physical: the row that was
+// appended, the new values of the assigned columns per updated row id, or the
+// deleted row ids, so replaying them needs no constraint checks.
+struct LogRecord {
+    uint64_t sequence;          // Log sequence number (LSN), increasing
+    LogRecordType type;
+    string tableName;
+
+    vector<Column> columns;     // CREATE_TABLE
+    StorageMode storageMode;    // CREATE_TABLE
+
+    string indexName;           // CREATE_INDEX, DROP_INDEX
+    string columnName;          // CREATE_INDEX
+
+    vector<size_t> columnIds;   // UPDATE: assigned columns
+    vector<size_t> rowIds;      // UPDATE, DELETE (ascending)
+    vector<Row> rows;           // INSERT: the new row; UPDATE: assigned values per row id
+
+    LogRecord() : sequence(0), type(LogRecordType::INSERT), storageMode(StorageMode::ROW) {}
+};
+
+// Append-only redo log (wal.log in the storage directory).
+//
+//   header   16 bytes: magic, version
+//   records  body length, CRC-32 of the body, then the body: LSN, type,
+//            table name and the type's fields, little-endian as in BinaryIO
+//
+// Records are buffered in memory and written with one fsync per commit, so
+// the statements of a batch share a single sync (group commit). A record is
+// durable once commit returns. Each table file stores the LSN of the last
+// record reflected in it, and replay skips the records a table already has.
+class WriteAheadLog {
+public:
+    static const uint32_t VERSION = 1;
+
+    // Opens the log, creating it if missing. An intact prefix of records is
+    // kept for replay; a torn or corrupt tail (a crash mid-append) is cut
+    // off. Throws runtime_error if the file cannot be opened or created.
+    explicit WriteAheadLog(const string& path);
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // Hands the records found on open to 'consumer', in order, once
+    void replay(const function<void(const LogRecord&)>& consumer);
+
+    // Each returns the record's LSN
+    uint64_t logCreateTable(const string& table, const vector<Column>& columns, StorageMode mode);
+    uint64_t logDropTable(const string& table);
+    uint64_t logCreateIndex(const string& table, const string& index, const string& column);
+    uint64_t logDropIndex(const string& table, const string& index);
+    uint64_t logInsert(const string& table, const Row& row);
+    // 'rows' are full rows; only the 'columns' values are logged
+    uint64_t logUpdate(const string& table, const vector<size_t>& columns,
+                       const vector<size_t>& rowIds, const vector<Row>& rows);
+    uint64_t logDelete(const string& table, const vector<size_t>& rowIds);
+
+    // Writes buffered records and syncs them; throws runtime_error on failure
+    void commit();
+    // Discards every record once a checkpoint has saved all tables
+    void reset();
+    // Discards records up to and including 'sequence', keeping later ones;
+    // throws runtime_error if the log cannot be rewritten
+    void discardThrough(uint64_t sequence);
+
+    // Keeps new LSNs above those already stored in table files
+    void advanceSequence(uint64_t next) { if (next > nextSequence) nextSequence = next; }
+    uint64_t getNextSequence() const { return nextSequence; }
+
+    // Bytes of records since the last reset, buffered ones included
+    uint64_t getSize() const { return fileSize + pending.size(); }
+
+    // Buffered records beyond this many bytes are written (not synced) early
+    void setGroupCommitBytes(size_t bytes) { groupCommitBytes = bytes; }
+
+private:
+    string path;
+    FILE* file;
+    string pending;             // Records not yet written
+    bool unsynced;              // Records written but not yet synced
+    uint64_t fileSize;          // Record bytes in the file, excluding the header
+    uint64_t nextSequence;
+    size_t groupCommitBytes;
+    string recovered;           // Intact records found on open, until replayed
+
+    void create();
+    // Opens the log again if a failed rewrite left it closed; throws
+    // runtime_error while it cannot be opened
+    void reopen();
+    void writePending();
+    uint64_t append(LogRecordType type, const string& table, const string& payload);
+};
@@ -5,6 +5,7 @@
 #include <QTreeWidgetItem>
 #include <QStandardItemModel>
 #include <QStandardItem>
+#include <QTimer>
 
 using namespace std;
 
@@ -18,12 +19,19 @@ MainWindow::MainWindow(QWidget *parent): QMainWindow(parent), ui(new Ui::MainWin
 
     // Load database on startup
     database = Database("data");
+    database.setMapTableFiles(true); // Row data is paged in as queries touch it
+    database.setMaxLoadedTables(64);
+    database.setWriteAheadLog(true); // Changes are durable without a Save
+    database.setCheckpointRate(64 * 1024 * 1024); // Leave disk bandwidth for queries
     database.loadAllTables();
 
     updateExplorerTree();
 
     printOutput("Welcome to SQL Studio!\n",false);
     printOutput("Database loaded: " + QString::number(database.getTableNames().size()) + " tables.\n\n",true);
+    for (const auto& message : database.getLoadErrors()) {
+        printError(QString::fromStdString(message));
+    }
 
     // Set callbacks for executor
     executor.setOutputCallback([this](const string& s,const bool focus) {
@@ -38,10 +46,26 @@ MainWindow::MainWindow(QWidget *parent): QMainWindow(parent), ui(new Ui::MainWin
     executor.setTreeRefreshCallback([this](){
         ui->tables_tree->update();
     });
+
+    // Checkpoints start and complete between statements, on this thread;
+    // the tables are written in the background
+    QTimer* checkpointTimer = new QTimer(this);
+    connect(checkpointTimer, &QTimer::timeout, this, [this]() {
+        try {
+            database.checkpointIfDue();
+        } catch (const exception& e) {
+            printError("Exception: " + QString(e.what()));
+        }
+    });
+    checkpointTimer->start(1000);
     }
 
 MainWindow::~MainWindow() {
-    database.saveAllTables();
+    try {
+        database.close();
+    } catch (const exception&) {
+        // Nothing left to report to; the log is replayed on the next start
+    }
     delete ui;
 }
 
@@ -52,7 +76,15 @@ void MainWindow::on_actionExecute_triggered() {
 }
 
 void MainWindow::on_actionSave_triggered() {
-    database.saveAllTables();
+    try {
+        if (database.isLogging()) {
+            database.startCheckpoint(); // Returns at once; tables are written in the background
+        } else {
+            database.saveAllTables();
+        }
+    } catch (const exception& e) {
+        printError("Exception: " + QString(e.what()));
+    }
 
 }
 
@@ -108,7 +140,7 @@ void MainWindow::executeSQL(const QString& sql) {
         for (char c : query) upperQuery += toupper(c);
         
         int statementCount = 0;
-        vector<string> keywords = {"SELECT", "INSERT", "UPDATE", "DELETE", "CREATE", "DROP"};
+        vector<string> keywords = {"SELECT", "INSERT", "UPDATE", "DELETE", "CREATE", "DROP", "COPY"};
         size_t searchPos = 0;
         
         for (const auto& keyword : keywords) {
@@ -150,6 +182,17 @@ void MainWindow::executeSQL(const QString& sql) {
 
         printOutput("",false); // newline
     }
+    try {
+        database.commitLog(); // One sync for the whole batch of statements
+    } catch (const exception& e) {
+        printError("Exception: " + QString(e.what()));
+    }
+    try {
+        database.evictColdTables(); // Safe here: no statement holds a Table*
+    } catch (const exception& e) {
+        // The table that failed to save stays loaded
+        printError("Exception: " + QString(e.what()));
+    }
     updateExplorerTree(); // Refresh explorer after changes
 }
 
@@ -160,7 +203,8 @@ void MainWindow::updateExplorerTree() {
     rootItem->setEditable(false);
     for (const auto& name : database.getTableNames()) {
         QStandardItem* table = new QStandardItem(QString::fromStdString(name));
-        for (const auto& col : (database.getTable(name)->getColumns()))
+        // Schema only, so the explorer does not load unloaded tables
+        for (const auto& col : *database.getTableColumns(name))
         {
             QStandardItem* column = new QStandardItem(QString::fromStdString(col.name));
             column->setIcon(QIcon(":icons/column.png"));
@@ -249,7 +293,7 @@ void MainWindow::populateResultsTable(const vector<Column>& cols, const vector<R
 
         for (const auto& val : row.values) {
             html += "<td>" +
-                    QString::fromStdString(val.data).toHtmlEscaped() +
+                    QString::fromStdString(val.toString()).toHtmlEscaped() +
                     "</td>";
         }
 